@@ -1,5 +1,6 @@
 #include "./AssetStore.h"
 #include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
 #include <SDL_image.h>
 
 AssetStore::AssetStore()
@@ -24,6 +25,16 @@ void AssetStore::ClearAssets()
 
 void AssetStore::AddTexture(SDL_Renderer* renderer,const std::string& assetId, const std::string& filePath)
 {
+	PROFILE_SCOPE_DETAIL("AssetStore::AddTexture", filePath.c_str());
+	numTexturesLoaded++;
+
+	// Headless runs have no renderer, the id is kept so lookups still work but no image is loaded
+	if (!renderer)
+	{
+		textures.emplace(assetId, nullptr);
+		return;
+	}
+
 	SDL_Surface* surface = IMG_Load(filePath.c_str());
 	SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
 	SDL_FreeSurface(surface);
@@ -34,6 +45,21 @@ void AssetStore::AddTexture(SDL_Renderer* renderer,const std::string& assetId, c
 	Logger::Log("New Texture added to the Asset Store with id = " + assetId);
 }
 
+void AssetStore::CollectMemoryStats(MemoryReport& report) const
+{
+	for (const auto& texture : textures)
+	{
+		size_t bytes = 0;
+		Uint32 format;
+		int width, height;
+		if (texture.second && SDL_QueryTexture(texture.second, &format, nullptr, &width, &height) == 0)
+		{
+			bytes = static_cast<size_t>(width) * height * SDL_BYTESPERPIXEL(format);
+		}
+		report.Add("texture", texture.first, bytes, bytes);
+	}
+}
+
 SDL_Texture* AssetStore::GetTexture(const std::string& assetId) 
 {
 	return textures[assetId];
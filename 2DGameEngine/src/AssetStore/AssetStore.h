@@ -3,12 +3,17 @@
 
 #include<map>
 #include<string>
+#include<cstdint>
 #include<SDL.h>
+#include "../Profiler/MemoryStats.h"
 
 class AssetStore
 {
 private:
 	std::map<std::string, SDL_Texture*> textures;
+
+	// Textures added since the store was created
+	uint64_t numTexturesLoaded = 0;
 	//TODO: create a map for fonts
 	//TODO: create a map for audio
 
@@ -19,6 +24,10 @@ public:
 	void ClearAssets();
 	void AddTexture(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath);
 	SDL_Texture* GetTexture(const std::string& assetId);
+	uint64_t GetNumTexturesLoaded() const { return numTexturesLoaded; }
+
+	// Adds an entry per texture, sized from its dimensions and pixel format (the memory lives on the GPU)
+	void CollectMemoryStats(MemoryReport& report) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "Benchmark.h"
+#include "../Logger/Logger.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+volatile double benchmarkSink = 0.0;
+
+bool BenchmarkSuite::IsSelected(const std::string& name) const
+{
+	return options.filter.empty() || name.find(options.filter) != std::string::npos;
+}
+
+void BenchmarkSuite::Record(const std::string& name, const std::string& variant, int numEntities, double nanosecondsPerOperation)
+{
+	BenchmarkResult result;
+	result.name = name;
+	result.variant = variant;
+	result.numEntities = numEntities;
+	result.nanosecondsPerOperation = nanosecondsPerOperation;
+	result.operationsPerSecond = nanosecondsPerOperation > 0.0 ? 1e9 / nanosecondsPerOperation : 0.0;
+	results.push_back(result);
+
+	std::printf("%-24s %-10s %9d %12.2f ns/op %14.0f op/s\n", name.c_str(), variant.c_str(), numEntities, result.nanosecondsPerOperation, result.operationsPerSecond);
+	std::fflush(stdout);
+}
+
+bool BenchmarkSuite::WriteResults(const std::string& path) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		Logger::Err("Cannot write benchmark results to " + path);
+		return false;
+	}
+
+	const bool isJson = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+	if (isJson)
+	{
+		file << "[\n";
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			const auto& result = results[i];
+			file << "  { \"benchmark\": \"" << result.name << "\", \"variant\": \"" << result.variant << "\", \"entities\": " << result.numEntities
+				<< ", \"ns_per_op\": " << result.nanosecondsPerOperation << ", \"ops_per_second\": " << result.operationsPerSecond << " }"
+				<< (i + 1 < results.size() ? ",\n" : "\n");
+		}
+		file << "]\n";
+	}
+	else
+	{
+		file << "benchmark,variant,entities,ns_per_op,ops_per_second\n";
+		for (const auto& result : results)
+		{
+			file << result.name << "," << result.variant << "," << result.numEntities << "," << result.nanosecondsPerOperation << "," << result.operationsPerSecond << "\n";
+		}
+	}
+
+	Logger::Log("Benchmark results written to " + path);
+	return true;
+}
+
+bool BenchmarkSuite::CompareWithBaseline(const std::string& path) const
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		Logger::Err("Cannot read benchmark baseline " + path);
+		return false;
+	}
+
+	// [key = benchmark,variant,entities] ns per operation
+	std::map<std::string, double> baseline;
+	std::string line;
+	std::getline(file, line);
+	while (std::getline(file, line))
+	{
+		std::stringstream fields(line);
+		std::string name, variant, entities, nanoseconds;
+		if (std::getline(fields, name, ',') && std::getline(fields, variant, ',') && std::getline(fields, entities, ',') && std::getline(fields, nanoseconds, ','))
+		{
+			baseline[name + "," + variant + "," + entities] = std::atof(nanoseconds.c_str());
+		}
+	}
+
+	bool isWithinThreshold = true;
+	std::printf("\nCompared with %s (regression above +%.0f%%)\n", path.c_str(), options.regressionThreshold * 100.0);
+	for (const auto& result : results)
+	{
+		const auto entry = baseline.find(result.name + "," + result.variant + "," + std::to_string(result.numEntities));
+		if (entry == baseline.end() || entry->second <= 0.0)
+		{
+			continue;
+		}
+
+		const double change = result.nanosecondsPerOperation / entry->second - 1.0;
+		const bool isRegression = change > options.regressionThreshold;
+		isWithinThreshold = isWithinThreshold && !isRegression;
+
+		std::printf("%-24s %-10s %9d %12.2f -> %12.2f ns/op %+7.1f%%%s\n", result.name.c_str(), result.variant.c_str(), result.numEntities,
+			entry->second, result.nanosecondsPerOperation, change * 100.0, isRegression ? "  REGRESSION" : "");
+	}
+	return isWithinThreshold;
+}
+
+int RunBenchmarks(const BenchmarkOptions& options)
+{
+	// The engine logs every entity and component it creates, which would be measured too
+	Logger::isInfoEnabled = false;
+
+	BenchmarkSuite suite(options);
+	std::printf("%-24s %-10s %9s %18s %19s\n", "benchmark", "variant", "entities", "time", "throughput");
+	RunEcsBenchmarks(suite);
+	RunCollisionBenchmarks(suite);
+
+	Logger::isInfoEnabled = true;
+
+	if (!options.outputPath.empty() && !suite.WriteResults(options.outputPath))
+	{
+		return 1;
+	}
+	if (!options.baselinePath.empty() && !suite.CompareWithBaseline(options.baselinePath))
+	{
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,109 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Command line settings of the benchmark mode (see Main.cpp)
+struct BenchmarkOptions
+{
+	// Entity counts every benchmark runs at
+	std::vector<int> sizes = { 1000, 100000, 1000000 };
+
+	// Results file, .json writes JSON, anything else CSV
+	std::string outputPath;
+
+	// CSV results of a previous run to compare against. Timings only compare on the same machine and build,
+	// so no baseline ships with the engine: record one with a Release build before a change
+	//   2DGameEngine --bench --bench-output baseline.csv
+	// then check the change against it with the same sizes and filter
+	//   2DGameEngine --bench --bench-baseline baseline.csv [--bench-threshold 10]
+	std::string baselinePath;
+
+	// A benchmark slower than the baseline by more than this fraction is reported as a regression
+	double regressionThreshold = 0.10;
+
+	// Only the benchmarks whose name contains this text run
+	std::string filter;
+};
+
+struct BenchmarkResult
+{
+	std::string name;
+	// What the benchmark ran on, such as the registry storage mode
+	std::string variant;
+	int numEntities;
+	double nanosecondsPerOperation;
+	double operationsPerSecond;
+};
+
+// Written by the benchmarks so the compiler cannot drop the work they measure
+extern volatile double benchmarkSink;
+
+/////////////////////////
+// BENCHMARK SUITE
+// Times a piece of work several times on fresh state and keeps the fastest run,
+// the one least disturbed by the rest of the machine
+/////////////////////////
+class BenchmarkSuite
+{
+private:
+	BenchmarkOptions options;
+	std::vector<BenchmarkResult> results;
+
+	void Record(const std::string& name, const std::string& variant, int numEntities, double nanosecondsPerOperation);
+
+public:
+	BenchmarkSuite(const BenchmarkOptions& options) : options(options) {}
+
+	const BenchmarkOptions& GetOptions() const { return options; }
+	const std::vector<BenchmarkResult>& GetResults() const { return results; }
+
+	bool IsSelected(const std::string& name) const;
+
+	// setup() prepares the state and is not timed, run() is timed and performs numOperations operations
+	template <typename TSetup, typename TRun>
+	void Measure(const std::string& name, const std::string& variant, int numEntities, int64_t numOperations, TSetup setup, TRun run);
+
+	bool WriteResults(const std::string& path) const;
+
+	// Returns false when a benchmark got slower than the baseline allows
+	bool CompareWithBaseline(const std::string& path) const;
+};
+
+template <typename TSetup, typename TRun>
+void BenchmarkSuite::Measure(const std::string& name, const std::string& variant, int numEntities, int64_t numOperations, TSetup setup, TRun run)
+{
+	if (!IsSelected(name))
+	{
+		return;
+	}
+
+	// Small sizes are repeated more, their runs are short and noisy
+	const int repetitions = std::clamp(1000000 / std::max(numEntities, 1), 3, 50);
+
+	double bestNanoseconds = std::numeric_limits<double>::max();
+	for (int i = 0; i < repetitions; i++)
+	{
+		setup();
+		const auto start = std::chrono::steady_clock::now();
+		run();
+		const auto end = std::chrono::steady_clock::now();
+		bestNanoseconds = std::min(bestNanoseconds, std::chrono::duration<double, std::nano>(end - start).count());
+	}
+
+	Record(name, variant, numEntities, bestNanoseconds / std::max<int64_t>(numOperations, 1));
+}
+
+// Each group of benchmarks adds its results to the suite
+void RunEcsBenchmarks(BenchmarkSuite& suite);
+void RunCollisionBenchmarks(BenchmarkSuite& suite);
+
+// Runs every benchmark, writes and compares the results, returns the process exit code
+int RunBenchmarks(const BenchmarkOptions& options);
+
+#endif
@@ -0,0 +1,367 @@
+#include "Benchmark.h"
+#include "../Physics/AABB.h"
+#include "../Physics/Broadphase.h"
+#include "../Physics/SpatialHash.h"
+#include "../Physics/AABBTree.h"
+#include "../Physics/StaticAABBTree.h"
+#include "../Physics/OverlapKernel.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <utility>
+
+// Above this many colliders the brute-force pass takes minutes, it is skipped
+const int MAX_BRUTE_FORCE_COLLIDERS = 20000;
+
+// Colliders per cluster of the clustered scene
+const int COLLIDERS_PER_CLUSTER = 64;
+
+// One collider in this many moves in the level scene, the others are scenery
+const int COLLIDERS_PER_DYNAMIC_COLLIDER = 10;
+
+// Both scenes hold 32x32 colliders on the same area, about 8 collider areas per collider whatever the count:
+// "uniform" spreads them evenly like a sparse map, "clustered" bunches them in tight groups like a crowd or a battle
+static std::vector<AABB> MakeScene(const std::string& scene, int numColliders)
+{
+	const float side = std::sqrt(numColliders * 32.0f * 32.0f * 8.0f);
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> position(0.0f, side);
+	std::normal_distribution<float> spread(0.0f, 48.0f);
+
+	std::vector<AABB> bounds;
+	bounds.reserve(numColliders);
+	float centerX = 0.0f;
+	float centerY = 0.0f;
+	for (int i = 0; i < numColliders; i++)
+	{
+		float x, y;
+		if (scene == "clustered")
+		{
+			if (i % COLLIDERS_PER_CLUSTER == 0)
+			{
+				centerX = position(random);
+				centerY = position(random);
+			}
+			x = centerX + spread(random);
+			y = centerY + spread(random);
+		}
+		else
+		{
+			x = position(random);
+			y = position(random);
+		}
+		bounds.emplace_back(x, y, x + 32.0f, y + 32.0f);
+	}
+	return bounds;
+}
+
+// The test CollisionSystem ran on every candidate pair before the overlap kernels, eight doubles per call
+static bool CheckAABBCollision(double aX, double aY, double aW, double aH, double bX, double bY, double bW, double bH)
+{
+	return aX < bX + bW && aX + aW > bX && aY < bY + bH && aY + aH > bY;
+}
+
+// Moves every collider by a few pixels, what a tick does to a scene
+static void MoveScene(std::vector<AABB>& bounds, std::mt19937& random)
+{
+	std::uniform_real_distribution<float> step(-2.0f, 2.0f);
+	for (auto& box : bounds)
+	{
+		const float dx = step(random);
+		const float dy = step(random);
+		box = AABB(box.minX + dx, box.minY + dy, box.maxX + dx, box.maxY + dy);
+	}
+}
+
+void RunCollisionBenchmarks(BenchmarkSuite& suite)
+{
+	const std::string scenes[] = { "uniform", "clustered" };
+	const BroadphaseType broadphaseTypes[] = { BroadphaseType::SpatialHash, BroadphaseType::SweepAndPrune, BroadphaseType::AABBTree };
+	const char* broadphaseVariants[] = { "hash", "sap", "tree" };
+	const int numBroadphases = sizeof(broadphaseTypes) / sizeof(broadphaseTypes[0]);
+
+	for (const auto& scene : scenes)
+	{
+		const std::string name = "collision_" + scene;
+		for (int n : suite.GetOptions().sizes)
+		{
+			if (!suite.IsSelected(name))
+			{
+				continue;
+			}
+
+			std::vector<AABB> bounds = MakeScene(scene, n);
+			std::vector<std::pair<int, int>> pairs;
+			std::mt19937 random(42);
+
+			// Every pair tested, what CollisionSystem did before it had a broadphase
+			if (n <= MAX_BRUTE_FORCE_COLLIDERS)
+			{
+				suite.Measure(name, "brute", n, n, []() {}, [&]()
+				{
+					int numCollisions = 0;
+					for (size_t i = 0; i < bounds.size(); i++)
+					{
+						for (size_t j = i + 1; j < bounds.size(); j++)
+						{
+							numCollisions += bounds[i].Overlaps(bounds[j]);
+						}
+					}
+					benchmarkSink = numCollisions;
+				});
+			}
+
+			// One tick of the collision system: the broadphase has seen the previous tick, then every collider moved a little
+			for (int type = 0; type < numBroadphases; type++)
+			{
+				std::unique_ptr<IBroadphase> broadphase = CreateBroadphase(broadphaseTypes[type], DEFAULT_COLLISION_CELL_SIZE);
+				broadphase->Update(bounds);
+				suite.Measure(name, broadphaseVariants[type], n, n, [&]()
+				{
+					MoveScene(bounds, random);
+				}, [&]()
+				{
+					broadphase->Update(bounds);
+					pairs.clear();
+					broadphase->FindPairs(pairs);
+					int numCollisions = 0;
+					for (const auto& pair : pairs)
+					{
+						numCollisions += bounds[pair.first].Overlaps(bounds[pair.second]);
+					}
+					benchmarkSink = numCollisions;
+				});
+			}
+		}
+	}
+
+	// A level: most colliders are scenery that never moves, the rest move every tick
+	// "all" gives every collider to the broadphase, "split" only the moving ones, checked against the baked scenery
+	for (int n : suite.GetOptions().sizes)
+	{
+		if (!suite.IsSelected("collision_level"))
+		{
+			break;
+		}
+
+		std::vector<AABB> bounds = MakeScene("uniform", n);
+		std::vector<AABB> dynamicBounds;
+		std::vector<AABB> staticBounds;
+		for (int i = 0; i < n; i++)
+		{
+			(i % COLLIDERS_PER_DYNAMIC_COLLIDER == 0 ? dynamicBounds : staticBounds).push_back(bounds[i]);
+		}
+		std::vector<std::pair<int, int>> pairs;
+		std::mt19937 random(42);
+
+		// The moving colliders first, so the same indices move in both variants
+		bounds = dynamicBounds;
+		bounds.insert(bounds.end(), staticBounds.begin(), staticBounds.end());
+		std::unique_ptr<IBroadphase> broadphase = CreateBroadphase(BroadphaseType::SpatialHash, DEFAULT_COLLISION_CELL_SIZE);
+		broadphase->Update(bounds);
+		suite.Measure("collision_level", "all", n, n, [&]()
+		{
+			MoveScene(dynamicBounds, random);
+			std::copy(dynamicBounds.begin(), dynamicBounds.end(), bounds.begin());
+		}, [&]()
+		{
+			broadphase->Update(bounds);
+			pairs.clear();
+			broadphase->FindPairs(pairs);
+			int numCollisions = 0;
+			for (const auto& pair : pairs)
+			{
+				numCollisions += bounds[pair.first].Overlaps(bounds[pair.second]);
+			}
+			benchmarkSink = numCollisions;
+		});
+
+		StaticAABBTree staticTree;
+		staticTree.Build(staticBounds);
+		broadphase = CreateBroadphase(BroadphaseType::SpatialHash, DEFAULT_COLLISION_CELL_SIZE);
+		broadphase->Update(dynamicBounds);
+		suite.Measure("collision_level", "split", n, n, [&]()
+		{
+			MoveScene(dynamicBounds, random);
+		}, [&]()
+		{
+			broadphase->Update(dynamicBounds);
+			pairs.clear();
+			broadphase->FindPairs(pairs);
+			int numCollisions = 0;
+			for (const auto& pair : pairs)
+			{
+				numCollisions += dynamicBounds[pair.first].Overlaps(dynamicBounds[pair.second]);
+			}
+			for (const auto& box : dynamicBounds)
+			{
+				staticTree.QueryAABB(box, [&numCollisions](int) { numCollisions++; return true; });
+			}
+			benchmarkSink = numCollisions;
+		});
+	}
+
+	// Narrowphase of one tick: the candidate pairs of the spatial hash tested pair by pair with doubles as CollisionSystem
+	// once did, on their boxes as it does below MIN_COLLIDERS_FOR_OVERLAP_KERNEL, or gathered into arrays and filtered
+	// by each kernel the processor supports, one operation per candidate pair
+	const OverlapKernelType kernelTypes[] = { OverlapKernelType::Scalar, OverlapKernelType::SSE2, OverlapKernelType::AVX2 };
+	for (int n : suite.GetOptions().sizes)
+	{
+		if (!suite.IsSelected("narrowphase"))
+		{
+			break;
+		}
+
+		const std::vector<AABB> bounds = MakeScene("uniform", n);
+		std::unique_ptr<IBroadphase> broadphase = CreateBroadphase(BroadphaseType::SpatialHash, DEFAULT_COLLISION_CELL_SIZE);
+		broadphase->Update(bounds);
+		std::vector<std::pair<int, int>> candidatePairs;
+		broadphase->FindPairs(candidatePairs);
+		const int numPairs = static_cast<int>(candidatePairs.size());
+
+		suite.Measure("narrowphase", "double", n, numPairs, []() {}, [&]()
+		{
+			int numCollisions = 0;
+			for (const auto& pair : candidatePairs)
+			{
+				const AABB& a = bounds[pair.first];
+				const AABB& b = bounds[pair.second];
+				numCollisions += CheckAABBCollision(a.minX, a.minY, a.GetWidth(), a.GetHeight(), b.minX, b.minY, b.GetWidth(), b.GetHeight());
+			}
+			benchmarkSink = numCollisions;
+		});
+
+		AABBArrays arrays;
+		std::vector<std::pair<int, int>> collidingPairs(candidatePairs.size());
+		suite.Measure("narrowphase", "direct", n, numPairs, []() {}, [&]()
+		{
+			int numColliding = 0;
+			for (const auto& pair : candidatePairs)
+			{
+				collidingPairs[numColliding] = pair;
+				numColliding += bounds[pair.first].Overlaps(bounds[pair.second]);
+			}
+			benchmarkSink = numColliding;
+		});
+
+		for (OverlapKernelType type : kernelTypes)
+		{
+			if (!IsOverlapKernelSupported(type))
+			{
+				continue;
+			}
+			const OverlapKernel& kernel = GetOverlapKernel(type);
+			suite.Measure("narrowphase", kernel.name, n, numPairs, []() {}, [&]()
+			{
+				arrays.Assign(bounds);
+				benchmarkSink = kernel.filterPairs(arrays, arrays, candidatePairs.data(), numPairs, collidingPairs.data());
+			});
+		}
+	}
+
+	// One box against every collider, as a brute-force query or pass does, one operation per box tested
+	const int numScans = 100;
+	for (int n : suite.GetOptions().sizes)
+	{
+		if (!suite.IsSelected("overlap_scan"))
+		{
+			break;
+		}
+
+		const std::vector<AABB> bounds = MakeScene("uniform", n);
+		const std::vector<AABB> queries = MakeScene("clustered", numScans);
+		AABBArrays arrays;
+		arrays.Assign(bounds);
+		std::vector<int> overlaps(bounds.size());
+
+		suite.Measure("overlap_scan", "double", n, static_cast<int64_t>(numScans) * n, []() {}, [&]()
+		{
+			int numOverlaps = 0;
+			for (const auto& query : queries)
+			{
+				for (const auto& box : bounds)
+				{
+					numOverlaps += CheckAABBCollision(query.minX, query.minY, query.GetWidth(), query.GetHeight(), box.minX, box.minY, box.GetWidth(), box.GetHeight());
+				}
+			}
+			benchmarkSink = numOverlaps;
+		});
+
+		for (OverlapKernelType type : kernelTypes)
+		{
+			if (!IsOverlapKernelSupported(type))
+			{
+				continue;
+			}
+			const OverlapKernel& kernel = GetOverlapKernel(type);
+			suite.Measure("overlap_scan", kernel.name, n, static_cast<int64_t>(numScans) * n, []() {}, [&]()
+			{
+				int numOverlaps = 0;
+				for (const auto& query : queries)
+				{
+					numOverlaps += kernel.findOverlaps(query, arrays, 0, n, overlaps.data());
+				}
+				benchmarkSink = numOverlaps;
+			});
+		}
+	}
+
+	// Rays of up to 512 pixels in every direction from random points, one operation per ray
+	const int numRays = 1000;
+	for (int n : suite.GetOptions().sizes)
+	{
+		if (!suite.IsSelected("raycast"))
+		{
+			break;
+		}
+
+		const std::vector<AABB> bounds = MakeScene("uniform", n);
+		const float side = std::sqrt(n * 32.0f * 32.0f * 8.0f);
+		std::mt19937 random(7);
+		std::uniform_real_distribution<float> position(0.0f, side);
+		std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+		std::vector<std::pair<glm::vec2, glm::vec2>> rays;
+		for (int i = 0; i < numRays; i++)
+		{
+			const float a = angle(random);
+			rays.emplace_back(glm::vec2(position(random), position(random)), glm::vec2(std::cos(a), std::sin(a)));
+		}
+
+		// Every box tested against every ray
+		if (n <= MAX_BRUTE_FORCE_COLLIDERS * 5)
+		{
+			suite.Measure("raycast", "brute", n, numRays, []() {}, [&]()
+			{
+				double totalDistance = 0.0;
+				for (const auto& ray : rays)
+				{
+					float closest = 512.0f;
+					for (const auto& box : bounds)
+					{
+						float distance;
+						if (IntersectRay(box, ray.first, ray.second, closest, distance))
+						{
+							closest = distance;
+						}
+					}
+					totalDistance += closest;
+				}
+				benchmarkSink = totalDistance;
+			});
+		}
+
+		AABBTreeBroadphase tree;
+		tree.Update(bounds);
+		suite.Measure("raycast", "tree", n, numRays, []() {}, [&]()
+		{
+			double totalDistance = 0.0;
+			for (const auto& ray : rays)
+			{
+				const RaycastHit hit = tree.GetTree().Raycast(ray.first, ray.second, 512.0f);
+				totalDistance += hit.HasHit() ? hit.distance : 512.0f;
+			}
+			benchmarkSink = totalDistance;
+		});
+	}
+}
@@ -0,0 +1,175 @@
+#include "Benchmark.h"
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Components/BoxColliderComponent.h"
+#include <memory>
+#include <random>
+
+// Iterates its members the way the systems of the game used to, one GetComponent() per component
+class BenchmarkSystem : public System
+{
+public:
+	BenchmarkSystem()
+	{
+		RequireComponent<TransformComponent>();
+		RequireComponent<RigidBodyComponent>(ComponentAccess::Read);
+	}
+
+	void Update(double deltaTime)
+	{
+		for (auto entity : GetSystemEntities())
+		{
+			auto& transform = entity.GetComponent<TransformComponent>();
+			const auto& rigidBody = entity.GetComponent<RigidBodyComponent>();
+			transform.position += rigidBody.velocity * static_cast<float>(deltaTime);
+		}
+	}
+};
+
+static std::vector<Entity> SpawnMovers(Registry& registry, int count)
+{
+	std::vector<Entity> entities = registry.CreateEntities(count, TransformComponent(), RigidBodyComponent(glm::vec2(1.0, 2.0)));
+	registry.Update();
+	return entities;
+}
+
+static void RunEcsBenchmarksWith(BenchmarkSuite& suite, StorageMode storageMode, int n)
+{
+	const std::string variant = storageMode == StorageMode::Archetype ? "archetype" : "sparse";
+
+	std::unique_ptr<Registry> registry;
+	std::vector<Entity> entities;
+	auto freshRegistry = [&]()
+	{
+		entities.clear();
+		registry = std::make_unique<Registry>(storageMode);
+	};
+	auto freshMovers = [&]()
+	{
+		freshRegistry();
+		entities = SpawnMovers(*registry, n);
+	};
+
+	suite.Measure("spawn", variant, n, n, freshRegistry, [&]()
+	{
+		for (int i = 0; i < n; i++)
+		{
+			Entity entity = registry->CreateEntity();
+			entity.AddComponent<TransformComponent>();
+			entity.AddComponent<RigidBodyComponent>(glm::vec2(1.0, 2.0));
+		}
+		registry->Update();
+	});
+
+	suite.Measure("spawn_bulk", variant, n, n, freshRegistry, [&]()
+	{
+		registry->CreateEntities(n, TransformComponent(), RigidBodyComponent(glm::vec2(1.0, 2.0)));
+		registry->Update();
+	});
+
+	suite.Measure("despawn", variant, n, n, freshMovers, [&]()
+	{
+		for (auto entity : entities)
+		{
+			entity.Kill();
+		}
+		registry->Update();
+	});
+
+	suite.Measure("add_component", variant, n, n, freshMovers, [&]()
+	{
+		for (auto entity : entities)
+		{
+			entity.AddComponent<BoxColliderComponent>(32, 32);
+		}
+		registry->Update();
+	});
+
+	suite.Measure("remove_component", variant, n, n, [&]()
+	{
+		freshMovers();
+		for (auto entity : entities)
+		{
+			entity.AddComponent<BoxColliderComponent>(32, 32);
+		}
+		registry->Update();
+	}, [&]()
+	{
+		for (auto entity : entities)
+		{
+			entity.RemoveComponent<BoxColliderComponent>();
+		}
+		registry->Update();
+	});
+
+	// Nothing waiting, the fixed cost paid every tick
+	const int numUpdates = 100;
+	suite.Measure("update_idle", variant, n, numUpdates, freshMovers, [&]()
+	{
+		for (int i = 0; i < numUpdates; i++)
+		{
+			registry->Update();
+		}
+	});
+
+	suite.Measure("get_component_random", variant, n, n, [&]()
+	{
+		freshMovers();
+		std::shuffle(entities.begin(), entities.end(), std::mt19937(42));
+	}, [&]()
+	{
+		double sum = 0.0;
+		for (auto entity : entities)
+		{
+			sum += entity.GetComponent<TransformComponent>().position.x;
+		}
+		benchmarkSink = sum;
+	});
+
+	suite.Measure("iterate_single", variant, n, n, freshMovers, [&]()
+	{
+		double sum = 0.0;
+		registry->View<TransformComponent>().Each([&sum](Entity, const TransformComponent& transform)
+		{
+			sum += transform.position.x;
+		});
+		benchmarkSink = sum;
+	});
+
+	// Half of the entities have both components, the view has to skip the others
+	suite.Measure("iterate_multi", variant, n, n / 2, [&]()
+	{
+		freshRegistry();
+		registry->CreateEntities(n / 2, TransformComponent(), RigidBodyComponent(glm::vec2(1.0, 2.0)));
+		registry->CreateEntities(n - n / 2, TransformComponent());
+		registry->Update();
+	}, [&]()
+	{
+		registry->View<TransformComponent, RigidBodyComponent>().Each([](Entity, TransformComponent& transform, const RigidBodyComponent& rigidBody)
+		{
+			transform.position += rigidBody.velocity * 0.016f;
+		});
+	});
+
+	suite.Measure("iterate_system", variant, n, n, [&]()
+	{
+		freshRegistry();
+		registry->AddSystem<BenchmarkSystem>();
+		entities = SpawnMovers(*registry, n);
+	}, [&]()
+	{
+		registry->GetSystem<BenchmarkSystem>().Update(0.016);
+	});
+}
+
+void RunEcsBenchmarks(BenchmarkSuite& suite)
+{
+	for (int n : suite.GetOptions().sizes)
+	{
+		for (auto storageMode : { StorageMode::SparseSet, StorageMode::Archetype })
+		{
+			RunEcsBenchmarksWith(suite, storageMode, n);
+		}
+	}
+}
@@ -1,14 +1,13 @@
 #ifndef ANIMATIONCOMPONENT_H
 #define ANIMATIONCOMPONENT_H
 
-#include <SDL.h>
-
 struct AnimationComponent
 {
 	int numFrames;
 	int currentFrame;
 	int frameSpeedRate;
 	bool isLoop;
+	// Simulation time in milliseconds when the animation started, -1 until the animation system first sees it
 	int startTime;
 
 	AnimationComponent(int numFrames = 1, int frameSpeedRate = 1, bool isLoop = true)
@@ -17,7 +16,7 @@ struct AnimationComponent
 		this->currentFrame = 1;
 		this->frameSpeedRate = frameSpeedRate;
 		this->isLoop = isLoop;
-		this->startTime = SDL_GetTicks();
+		this->startTime = -1;
 	}
 };
 
@@ -8,12 +8,16 @@ struct BoxColliderComponent
 	int width;
 	int height;
 	glm::vec2 offset;
+	// Baked into the static colliders even if the entity has a rigid body, moving it then takes
+	// CollisionSystem::InvalidateStaticColliders(). Entities without a rigid body are static without the flag
+	bool isStatic;
 
-	BoxColliderComponent(int width = 0, int height = 0, glm::vec2 offset = glm::vec2(0))
+	BoxColliderComponent(int width = 0, int height = 0, glm::vec2 offset = glm::vec2(0), bool isStatic = false)
 	{
 		this->width = width;
 		this->height = height;
 		this->offset = offset;
+		this->isStatic = isStatic;
 	}
 };
 
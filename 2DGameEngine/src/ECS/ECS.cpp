@@ -1,8 +1,30 @@
 #include "ECS.h"
 #include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
+#include <chrono>
+#include <cctype>
 
 int IComponent::nextId = 0;
 
+std::string GetTypeName(const std::type_info& type)
+{
+	// MSVC names types "class MovementSystem", GCC and Clang prefix the length "14MovementSystem"
+	std::string name = type.name();
+	for (const std::string prefix : { "class ", "struct " })
+	{
+		if (name.compare(0, prefix.size(), prefix) == 0)
+		{
+			name.erase(0, prefix.size());
+		}
+	}
+	size_t firstLetter = 0;
+	while (firstLetter < name.size() && std::isdigit(static_cast<unsigned char>(name[firstLetter])))
+	{
+		firstLetter++;
+	}
+	return name.substr(firstLetter);
+}
+
 int Entity::GetId() const
 {
 	return id;
@@ -15,28 +37,415 @@ void Entity::Kill()
 
 void System::AddEntityToSystem(Entity entity)
 {
+	const auto entityId = entity.GetId();
+
+	if (HasEntity(entity))
+	{
+		return;
+	}
+
+	if (entityId >= static_cast<int>(entityIdToIndex.size()))
+	{
+		entityIdToIndex.resize(entityId + 1, -1);
+	}
+
+	entityIdToIndex[entityId] = static_cast<int>(entities.size());
 	entities.push_back(entity);
+	membershipVersion++;
 }
 
 void System::RemoveEntityFromSystem(Entity entity)
 {
-	entities.erase(std::remove_if(entities.begin(), entities.end(), [&entity](Entity other) {
-		return entity == other;
-		}), entities.end());
+	if (!HasEntity(entity))
+	{
+		return;
+	}
+
+	// Move the last entity into the removed slot instead of shifting the whole list
+	const int indexOfRemoved = entityIdToIndex[entity.GetId()];
+	const Entity last = entities.back();
+	entities[indexOfRemoved] = last;
+	entityIdToIndex[last.GetId()] = indexOfRemoved;
+
+	entityIdToIndex[entity.GetId()] = -1;
+	entities.pop_back();
+	membershipVersion++;
+}
+
+void System::RemoveEntitiesFromSystem(const std::vector<Entity>& entitiesToRemove)
+{
+	if (entities.empty())
+	{
+		return;
+	}
+
+	for (auto entity : entitiesToRemove)
+	{
+		RemoveEntityFromSystem(entity);
+	}
 }
 
-std::vector<Entity> System::GetSystemEntities() const
+bool System::HasEntity(Entity entity) const
+{
+	const auto entityId = entity.GetId();
+	return entityId < static_cast<int>(entityIdToIndex.size()) && entityIdToIndex[entityId] != -1;
+}
+
+const std::vector<Entity>& System::GetSystemEntities() const
 {
 	return entities;
 }
 
+bool System::ConflictsWith(const System& other) const
+{
+	const bool writesWhatOtherUses = !(writeSignature & other.readSignature).none() || !(writeSignature & other.writeSignature).none();
+	const bool readsWhatOtherWrites = !(readSignature & other.writeSignature).none();
+	return writesWhatOtherUses || readsWhatOtherWrites;
+}
+
+size_t System::GetUsedBytes() const
+{
+	return entities.size() * sizeof(Entity) + entityIdToIndex.size() * sizeof(int);
+}
+
+size_t System::GetCapacityBytes() const
+{
+	return entities.capacity() * sizeof(Entity) + entityIdToIndex.capacity() * sizeof(int);
+}
+
 const Signature& System::GetComponentSignature() const
 {
 	return componentSignature;
 }
 
 
-Entity Registry::CreateEntity()
+std::string Archetype::GetName() const
+{
+	std::string name;
+	for (auto info : componentInfos)
+	{
+		name += (name.empty() ? "" : ", ") + info->name;
+	}
+	return name;
+}
+
+size_t Archetype::GetUsedBytes() const
+{
+	size_t rowSize = sizeof(int);
+	for (auto info : componentInfos)
+	{
+		rowSize += info->size;
+	}
+	return numEntities * rowSize;
+}
+
+Archetype::Archetype(const Signature& signature, const std::vector<ComponentInfo>& infos) :
+	signature(signature),
+	componentColumns(MAX_COMPONENTS, -1),
+	addEdges(MAX_COMPONENTS, nullptr),
+	removeEdges(MAX_COMPONENTS, nullptr)
+{
+	size_t rowSize = sizeof(int);
+	for (int componentId = 0; componentId < static_cast<int>(MAX_COMPONENTS); componentId++)
+	{
+		if (signature.test(componentId))
+		{
+			componentColumns[componentId] = static_cast<int>(componentIds.size());
+			componentIds.push_back(componentId);
+			componentInfos.push_back(&infos[componentId]);
+			rowSize += infos[componentId].size;
+		}
+	}
+
+	// Fit as many rows as possible in a chunk, leaving room for the padding between the columns
+	chunkCapacity = static_cast<int>(ARCHETYPE_CHUNK_SIZE / rowSize);
+	while (chunkCapacity > 1)
+	{
+		size_t offset = sizeof(int) * chunkCapacity;
+		columnOffsets.clear();
+		for (auto info : componentInfos)
+		{
+			offset = (offset + info->alignment - 1) / info->alignment * info->alignment;
+			columnOffsets.push_back(offset);
+			offset += info->size * chunkCapacity;
+		}
+		if (offset <= ARCHETYPE_CHUNK_SIZE)
+		{
+			break;
+		}
+		chunkCapacity--;
+	}
+}
+
+Archetype::~Archetype()
+{
+	for (int row = 0; row < numEntities; row++)
+	{
+		for (auto componentId : componentIds)
+		{
+			componentInfos[componentColumns[componentId]]->destroy(GetComponent(row, componentId));
+		}
+	}
+}
+
+int Archetype::AllocateRow(int entityId)
+{
+	const int row = numEntities++;
+	if (row / chunkCapacity >= GetNumChunks())
+	{
+		chunks.push_back(std::make_unique<ArchetypeChunk>());
+	}
+	GetEntityIds(row / chunkCapacity)[row % chunkCapacity] = entityId;
+	return row;
+}
+
+int Archetype::RemoveRow(int row)
+{
+	const int lastRow = numEntities - 1;
+	int movedEntityId = -1;
+
+	for (auto componentId : componentIds)
+	{
+		const auto info = componentInfos[componentColumns[componentId]];
+		info->destroy(GetComponent(row, componentId));
+		if (row != lastRow)
+		{
+			// Keep the rows packed by moving the last one into the hole
+			void* last = GetComponent(lastRow, componentId);
+			info->moveConstruct(GetComponent(row, componentId), last);
+			info->destroy(last);
+		}
+	}
+	if (row != lastRow)
+	{
+		movedEntityId = GetEntityIds(lastRow / chunkCapacity)[lastRow % chunkCapacity];
+		GetEntityIds(row / chunkCapacity)[row % chunkCapacity] = movedEntityId;
+	}
+
+	numEntities--;
+	if (numEntities % chunkCapacity == 0)
+	{
+		// The last chunk is now empty
+		chunks.pop_back();
+	}
+	return movedEntityId;
+}
+
+Archetype* ArchetypeStorage::GetOrCreateArchetype(const Signature& signature)
+{
+	for (auto& archetype : archetypes)
+	{
+		if (archetype->GetSignature() == signature)
+		{
+			return archetype.get();
+		}
+	}
+	archetypes.push_back(std::make_unique<Archetype>(signature, componentInfos));
+	return archetypes.back().get();
+}
+
+Archetype* ArchetypeStorage::GetArchetypeWith(Archetype* archetype, int componentId)
+{
+	if (!archetype)
+	{
+		Signature signature;
+		signature.set(componentId);
+		return GetOrCreateArchetype(signature);
+	}
+	if (!archetype->addEdges[componentId])
+	{
+		Signature signature = archetype->GetSignature();
+		signature.set(componentId);
+		archetype->addEdges[componentId] = GetOrCreateArchetype(signature);
+	}
+	return archetype->addEdges[componentId];
+}
+
+Archetype* ArchetypeStorage::GetArchetypeWithout(Archetype* archetype, int componentId)
+{
+	Signature signature = archetype->GetSignature();
+	signature.set(componentId, false);
+	if (signature.none())
+	{
+		return nullptr;
+	}
+	if (!archetype->removeEdges[componentId])
+	{
+		archetype->removeEdges[componentId] = GetOrCreateArchetype(signature);
+	}
+	return archetype->removeEdges[componentId];
+}
+
+int ArchetypeStorage::MoveEntity(int entityId, Archetype* destination)
+{
+	const EntityLocation source = entityLocations[entityId];
+	int row = -1;
+
+	if (destination)
+	{
+		row = destination->AllocateRow(entityId);
+		if (source.archetype)
+		{
+			for (auto componentId : destination->componentIds)
+			{
+				if (source.archetype->HasComponent(componentId))
+				{
+					componentInfos[componentId].moveConstruct(destination->GetComponent(row, componentId), source.archetype->GetComponent(source.row, componentId));
+				}
+			}
+		}
+	}
+
+	if (source.archetype)
+	{
+		const int movedEntityId = source.archetype->RemoveRow(source.row);
+		if (movedEntityId != -1)
+		{
+			entityLocations[movedEntityId].row = source.row;
+		}
+	}
+
+	entityLocations[entityId].archetype = destination;
+	entityLocations[entityId].row = row;
+	return row;
+}
+
+void ArchetypeStorage::RemoveComponent(int entityId, int componentId)
+{
+	if (entityId >= static_cast<int>(entityLocations.size()))
+	{
+		return;
+	}
+	Archetype* archetype = entityLocations[entityId].archetype;
+	if (!archetype || !archetype->HasComponent(componentId))
+	{
+		return;
+	}
+	MoveEntity(entityId, GetArchetypeWithout(archetype, componentId));
+}
+
+void* ArchetypeStorage::GetComponent(int entityId, int componentId) const
+{
+	const EntityLocation& location = entityLocations[entityId];
+	return location.archetype->GetComponent(location.row, componentId);
+}
+
+void ArchetypeStorage::RemoveEntity(int entityId)
+{
+	if (entityId < static_cast<int>(entityLocations.size()) && entityLocations[entityId].archetype)
+	{
+		MoveEntity(entityId, nullptr);
+	}
+}
+
+
+CommandBuffer::~CommandBuffer()
+{
+	Clear();
+}
+
+void* CommandBuffer::Allocate(size_t size, size_t alignment)
+{
+	while (true)
+	{
+		if (currentBlock == arena.size())
+		{
+			ArenaBlock block;
+			block.size = std::max(ARENA_BLOCK_SIZE, size + alignment);
+			block.bytes = std::make_unique<unsigned char[]>(block.size);
+			block.used = 0;
+			arena.push_back(std::move(block));
+		}
+
+		ArenaBlock& block = arena[currentBlock];
+		const uintptr_t address = reinterpret_cast<uintptr_t>(block.bytes.get()) + block.used;
+		const size_t padding = (alignment - address % alignment) % alignment;
+		if (block.used + padding + size <= block.size)
+		{
+			block.used += padding + size;
+			return reinterpret_cast<void*>(address + padding);
+		}
+		currentBlock++;
+	}
+}
+
+Entity CommandBuffer::CreateEntity()
+{
+	Entity entity(registry->TakeEntityId());
+	entity.registry = registry;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	entitiesToCreate.push_back(entity.GetId());
+	return entity;
+}
+
+void CommandBuffer::KillEntity(Entity entity)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	entitiesToKill.push_back(entity.GetId());
+}
+
+bool CommandBuffer::IsEmpty()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return entitiesToCreate.empty() && entitiesToKill.empty() && componentCommands.empty();
+}
+
+void CommandBuffer::PlayComponentCommands(const std::vector<int>& killedEntityIds)
+{
+	// Group the commands by component type, then entity, in recording order
+	std::sort(componentCommands.begin(), componentCommands.end(), [](const ComponentCommand& a, const ComponentCommand& b)
+		{
+			if (a.componentId != b.componentId) return a.componentId < b.componentId;
+			if (a.entityId != b.entityId) return a.entityId < b.entityId;
+			return a.sequence < b.sequence;
+		});
+
+	for (size_t i = 0; i < componentCommands.size(); i++)
+	{
+		const ComponentCommand& command = componentCommands[i];
+
+		// Only the last command on the same entity and component matters
+		const bool isOverridden = i + 1 < componentCommands.size() &&
+			componentCommands[i + 1].componentId == command.componentId &&
+			componentCommands[i + 1].entityId == command.entityId;
+
+		const bool isKilled = std::binary_search(killedEntityIds.begin(), killedEntityIds.end(), command.entityId);
+
+		if (!isOverridden && !isKilled)
+		{
+			command.apply(*registry, command.entityId, command.component);
+		}
+	}
+}
+
+void CommandBuffer::Clear()
+{
+	for (auto& command : componentCommands)
+	{
+		if (command.destroy)
+		{
+			command.destroy(command.component);
+		}
+	}
+	componentCommands.clear();
+	entitiesToCreate.clear();
+	entitiesToKill.clear();
+
+	for (auto& block : arena)
+	{
+		block.used = 0;
+	}
+	currentBlock = 0;
+}
+
+int Registry::TakeEntityId()
+{
+	std::lock_guard<std::mutex> lock(entityIdMutex);
+	return TakeEntityIdLocked();
+}
+
+int Registry::TakeEntityIdLocked()
 {
 	int entityId;
 
@@ -44,12 +453,6 @@ Entity Registry::CreateEntity()
 	{
 		// if there are no free ids wainting to be reused
 		entityId = numEntities++;
-
-		// Make sure the entityComponentSignatures vector can accomodate the new entity
-		if (entityId >= entityComponentSignatures.size())
-		{
-			entityComponentSignatures.resize(entityId + 1);
-		}
 	}
 	else
 	{
@@ -57,10 +460,24 @@ Entity Registry::CreateEntity()
 		entityId = freeIds.front();
 		freeIds.pop_front();
 	}
+	numEntitiesCreated++;
+
+	return entityId;
+}
+
+Entity Registry::CreateEntity()
+{
+	const int entityId = TakeEntityId();
+
+	// Make sure the entityComponentSignatures vector can accomodate the new entity
+	if (entityId >= static_cast<int>(entityComponentSignatures.size()))
+	{
+		entityComponentSignatures.resize(entityId + 1);
+	}
 
 	Entity entity(entityId);
 	entity.registry = this;
-	entitiesToBeAdded.insert(entity);
+	entitiesToBeAdded.push_back(entity);
 
 	Logger::Log("Entity created with id = " + std::to_string(entityId));
 
@@ -69,7 +486,7 @@ Entity Registry::CreateEntity()
 
 void Registry::KillEntity(Entity entity)
 {
-	entitiesToBeKilled.insert(entity);
+	commandBuffer.KillEntity(entity);
 }
 
 void Registry::AddEntityToSystems(Entity entity)
@@ -83,28 +500,230 @@ void Registry::AddEntityToSystems(Entity entity)
 	// Loop all the systems
 	for (auto& system : systems)
 	{
-		const auto& systemComponentSignature = system.second->GetComponentSignature();
+		const auto& systemComponentSignature = system.system->GetComponentSignature();
 
-		bool isInsterested = (entityComponentSignature & systemComponentSignature) == systemComponentSignature;
+		bool isInsterested = entityComponentSignature.Contains(systemComponentSignature);
 
 		if (isInsterested)
 		{
-			system.second->AddEntityToSystem(entity);
+			system.system->AddEntityToSystem(entity);
+		}
+	}
+}
+
+void Registry::RebuildSystemsByComponent()
+{
+	systemsByComponent.assign(MAX_COMPONENTS, {});
+	systemsUsingComponent.assign(MAX_COMPONENTS, {});
+	for (const auto& system : systems)
+	{
+		const auto& systemComponentSignature = system.system->GetComponentSignature();
+		for (size_t componentId = 0; componentId < MAX_COMPONENTS; componentId++)
+		{
+			if (systemComponentSignature.test(componentId))
+			{
+				systemsByComponent[componentId].push_back(system.system.get());
+			}
+			else if (system.system->readSignature.test(componentId) || system.system->writeSignature.test(componentId))
+			{
+				systemsUsingComponent[componentId].push_back(system.system.get());
+			}
+		}
+	}
+}
+
+void Registry::CollectMemoryStats(MemoryReport& report) const
+{
+	for (const auto& pool : componentPools)
+	{
+		if (pool)
+		{
+			report.Add("component pool", pool->GetComponentName(), pool->GetUsedBytes(), pool->GetCapacityBytes());
+		}
+	}
+	for (const auto& archetype : archetypeStorage.GetArchetypes())
+	{
+		report.Add("archetype", archetype->GetName(), archetype->GetUsedBytes(), archetype->GetCapacityBytes());
+	}
+	for (const auto& system : systems)
+	{
+		report.Add("system", system.system->GetName(), system.system->GetUsedBytes(), system.system->GetCapacityBytes());
+	}
+
+	report.Add("registry", "entity signatures", entityComponentSignatures.size() * sizeof(Signature), entityComponentSignatures.capacity() * sizeof(Signature));
+	report.Add("registry", "free entity ids", freeIds.size() * sizeof(int), freeIds.size() * sizeof(int));
+	report.Add("registry", "pending changes",
+		entitiesToBeAdded.size() * sizeof(Entity) + signatureChanges.size() * sizeof(std::pair<int, int>),
+		entitiesToBeAdded.capacity() * sizeof(Entity) + signatureChanges.capacity() * sizeof(std::pair<int, int>));
+}
+
+void Registry::RebuildSystemsByPhase()
+{
+	for (auto& phase : systemsByPhase)
+	{
+		phase.clear();
+	}
+	for (const auto& system : systems)
+	{
+		systemsByPhase[static_cast<int>(system.system->GetPhase())].push_back(system.system.get());
+	}
+
+	// A system depends on every earlier system of its phase it conflicts with, so conflicting systems
+	// keep their registration order and the others are free to overlap
+	for (int phase = 0; phase < NUM_SYSTEM_PHASES; phase++)
+	{
+		const auto& phaseSystems = systemsByPhase[phase];
+		auto& graph = systemGraph[phase];
+		graph.assign(phaseSystems.size(), SystemNode());
+
+		for (size_t i = 0; i < phaseSystems.size(); i++)
+		{
+			for (size_t j = 0; j < i; j++)
+			{
+				if (phaseSystems[i]->ConflictsWith(*phaseSystems[j]))
+				{
+					graph[j].dependents.push_back(static_cast<int>(i));
+					graph[i].numDependencies++;
+				}
+			}
+		}
+	}
+}
+
+void Registry::RunSystem(System& system, FrameContext& context)
+{
+	const auto start = std::chrono::steady_clock::now();
+	system.Run(context);
+	const auto end = std::chrono::steady_clock::now();
+
+	system.lastRunMilliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+	system.totalRunMilliseconds += system.lastRunMilliseconds;
+	system.runCount++;
+	Profiler::AddSample(system.name.c_str(), start, end);
+}
+
+void Registry::RunPhase(SystemPhase phase, FrameContext& context)
+{
+	const auto& phaseSystems = systemsByPhase[static_cast<int>(phase)];
+	const auto& graph = systemGraph[static_cast<int>(phase)];
+
+	if (!jobSystem || jobSystem->GetNumThreads() == 1 || phase == SystemPhase::Render || phaseSystems.size() < 2)
+	{
+		for (auto system : phaseSystems)
+		{
+			RunSystem(*system, context);
+		}
+		return;
+	}
+
+	// Dependencies left before each system can start this frame
+	std::vector<std::atomic<int>> remainingDependencies(graph.size());
+	for (size_t i = 0; i < graph.size(); i++)
+	{
+		remainingDependencies[i].store(graph[i].numDependencies, std::memory_order_relaxed);
+	}
+
+	// Runs a system, then queues the dependents it was the last dependency of
+	JobCounter counter;
+	std::function<void(int)> runNode = [&](int node)
+	{
+		RunSystem(*phaseSystems[node], context);
+		for (int dependent : graph[node].dependents)
+		{
+			if (remainingDependencies[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				jobSystem->Submit([&runNode, dependent]() { runNode(dependent); }, &counter);
+			}
+		}
+	};
+
+	for (size_t i = 0; i < graph.size(); i++)
+	{
+		if (graph[i].numDependencies == 0)
+		{
+			const int node = static_cast<int>(i);
+			jobSystem->Submit([&runNode, node]() { runNode(node); }, &counter);
 		}
 	}
+	jobSystem->Wait(counter);
+}
+
+void Registry::UpdateSystemsMembership()
+{
+	// The same component can change several times in a frame, only look at it once
+	std::sort(signatureChanges.begin(), signatureChanges.end());
+	signatureChanges.erase(std::unique(signatureChanges.begin(), signatureChanges.end()), signatureChanges.end());
+
+	for (const auto& change : signatureChanges)
+	{
+		Entity entity(change.first);
+		entity.registry = this;
+		const auto& entityComponentSignature = entityComponentSignatures[change.first];
+
+		for (auto system : systemsByComponent[change.second])
+		{
+			const auto& systemComponentSignature = system->GetComponentSignature();
+			const bool isInterested = entityComponentSignature.Contains(systemComponentSignature);
+
+			if (isInterested)
+			{
+				system->AddEntityToSystem(entity);
+			}
+			else
+			{
+				system->RemoveEntityFromSystem(entity);
+			}
+		}
+
+		for (auto system : systemsUsingComponent[change.second])
+		{
+			if (system->HasEntity(entity))
+			{
+				system->membershipVersion++;
+			}
+		}
+	}
+	signatureChanges.clear();
 }
 
 void Registry::RemoveEntityFromSystems(Entity entity)
 {
-	for (auto system : systems)
+	for (const auto& system : systems)
 	{
-		system.second->RemoveEntityFromSystem(entity);
+		system.system->RemoveEntityFromSystem(entity);
+	}
+}
+
+void Registry::RemoveEntitiesFromSystems(const std::vector<Entity>& entities)
+{
+	for (const auto& system : systems)
+	{
+		system.system->RemoveEntitiesFromSystem(entities);
 	}
 }
 
 
 void Registry::Update()
 {
+	// Entities created through the command buffer already have an id, make room for their signature
+	for (auto entityId : commandBuffer.entitiesToCreate)
+	{
+		if (entityId >= static_cast<int>(entityComponentSignatures.size()))
+		{
+			entityComponentSignatures.resize(entityId + 1);
+		}
+		Entity entity(entityId);
+		entity.registry = this;
+		entitiesToBeAdded.push_back(entity);
+	}
+
+	// An entity can be killed several times in the same frame, only kill it once
+	std::vector<int>& killedEntityIds = commandBuffer.entitiesToKill;
+	std::sort(killedEntityIds.begin(), killedEntityIds.end());
+	killedEntityIds.erase(std::unique(killedEntityIds.begin(), killedEntityIds.end()), killedEntityIds.end());
+
+	commandBuffer.PlayComponentCommands(killedEntityIds);
+
 	// Add the entities that are waiting to be created to the active Systems
 	for (auto entity : entitiesToBeAdded)
 	{
@@ -112,14 +731,42 @@ void Registry::Update()
 	}
 	entitiesToBeAdded.clear();
 
+	// Entities that gained or lost components join or leave the systems that care about them
+	UpdateSystemsMembership();
+
+	std::vector<Entity> entitiesToBeKilled;
+	entitiesToBeKilled.reserve(killedEntityIds.size());
+	for (auto entityId : killedEntityIds)
+	{
+		Entity entity(entityId);
+		entity.registry = this;
+		entitiesToBeKilled.push_back(entity);
+	}
+
+	// Remove the killed entities from the systems, one batch per system
+	RemoveEntitiesFromSystems(entitiesToBeKilled);
+
 	for (auto entity : entitiesToBeKilled)
 	{
-		RemoveEntityFromSystems(entity);
-		
 		entityComponentSignatures[entity.GetId()].reset();
 
+		// Remove the entity from the component storage
+		if (storageMode == StorageMode::Archetype)
+		{
+			archetypeStorage.RemoveEntity(entity.GetId());
+		}
+		for (auto& pool : componentPools)
+		{
+			if (pool)
+			{
+				pool->RemoveEntityFromPool(entity.GetId());
+			}
+		}
+
 		// Make the entity id available to be reused 
 		freeIds.push_back(entity.GetId());
 	}
-	entitiesToBeKilled.clear();
+	numEntitiesKilled += entitiesToBeKilled.size();
+
+	commandBuffer.Clear();
 }
\ No newline at end of file
@@ -2,23 +2,169 @@
 #define ECS_H
 
 #include <vector>
-#include <bitset>
-#include <set>
-#include <unordered_map>
+#include <string>
 #include <typeindex>
 #include <memory>
 #include <deque>
+#include <tuple>
+#include <new>
+#include <algorithm>
+#include <mutex>
+#include <cstdint>
+#include <cassert>
 
 #include "../Logger/Logger.h"
-const unsigned int MAX_COMPONENTS = 32;
+#include "../Jobs/JobSystem.h"
+#include "../Profiler/MemoryStats.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ECS_SIGNATURE_SSE2
+#endif
+
+// Number of component types the engine supports, can be raised from the build settings
+#ifndef ECS_MAX_COMPONENTS
+#define ECS_MAX_COMPONENTS 64
+#endif
+const unsigned int MAX_COMPONENTS = ECS_MAX_COMPONENTS;
 
 
 /////////////////////////
 // SIGNATURE
 // WE USE A BITSET TO KEEP TRACK OF WHICH COMPONENTS AN ENTITY HAS.
 // AND ALSO KEEP TRACK OF WHICH ENITITIES A SYSTEM IS INTERESTED IN.
+// Up to 64 components the mask is a single word, past that it is an array of
+// words compared 128 bits at a time with SSE2 when it is available.
 /////////////////////////
-typedef std::bitset<MAX_COMPONENTS> Signature;
+// Wide masks are padded to an even number of words to be compared in SSE2 registers
+constexpr size_t GetComponentMaskNumWords(size_t numBits)
+{
+	return numBits <= 64 ? 1 : ((numBits + 127) / 128) * 2;
+}
+
+// Words of a wide mask are aligned for the SSE2 loads, a single word keeps its natural 8 bytes
+template <size_t NUM_WORDS>
+struct ComponentMaskWords
+{
+	alignas(16) uint64_t words[NUM_WORDS] = {};
+};
+
+template <>
+struct ComponentMaskWords<1>
+{
+	uint64_t words[1] = {};
+};
+
+template <size_t N>
+class ComponentMask : private ComponentMaskWords<GetComponentMaskNumWords(N)>
+{
+private:
+	static constexpr size_t NUM_WORDS = GetComponentMaskNumWords(N);
+
+	using ComponentMaskWords<NUM_WORDS>::words;
+
+public:
+	void set(size_t bit, bool value = true)
+	{
+		if (value)
+		{
+			words[bit / 64] |= uint64_t(1) << (bit % 64);
+		}
+		else
+		{
+			words[bit / 64] &= ~(uint64_t(1) << (bit % 64));
+		}
+	}
+
+	bool test(size_t bit) const
+	{
+		return (words[bit / 64] >> (bit % 64)) & 1;
+	}
+
+	void reset()
+	{
+		for (auto& word : words)
+		{
+			word = 0;
+		}
+	}
+
+	bool none() const
+	{
+		for (auto word : words)
+		{
+			if (word)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Returns true if every bit set in other is also set in this mask
+	bool Contains(const ComponentMask& other) const
+	{
+		if constexpr (NUM_WORDS == 1)
+		{
+			return (words[0] & other.words[0]) == other.words[0];
+		}
+		else
+		{
+#ifdef ECS_SIGNATURE_SSE2
+			for (size_t i = 0; i < NUM_WORDS; i += 2)
+			{
+				const __m128i mine = _mm_load_si128(reinterpret_cast<const __m128i*>(&words[i]));
+				const __m128i required = _mm_load_si128(reinterpret_cast<const __m128i*>(&other.words[i]));
+				const __m128i equal = _mm_cmpeq_epi32(_mm_and_si128(mine, required), required);
+				if (_mm_movemask_epi8(equal) != 0xFFFF)
+				{
+					return false;
+				}
+			}
+			return true;
+#else
+			for (size_t i = 0; i < NUM_WORDS; i++)
+			{
+				if ((words[i] & other.words[i]) != other.words[i])
+				{
+					return false;
+				}
+			}
+			return true;
+#endif
+		}
+	}
+
+	ComponentMask operator &(const ComponentMask& other) const
+	{
+		ComponentMask result;
+		for (size_t i = 0; i < NUM_WORDS; i++)
+		{
+			result.words[i] = words[i] & other.words[i];
+		}
+		return result;
+	}
+
+	bool operator ==(const ComponentMask& other) const
+	{
+		for (size_t i = 0; i < NUM_WORDS; i++)
+		{
+			if (words[i] != other.words[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool operator !=(const ComponentMask& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+typedef ComponentMask<MAX_COMPONENTS> Signature;
+static_assert(MAX_COMPONENTS > 64 || sizeof(Signature) == sizeof(uint64_t), "A signature of up to 64 components is a single word");
 
 struct IComponent
 {
@@ -29,11 +175,15 @@ protected:
 template <typename T>
 class Component: public IComponent
 {
+private:
+	// Assigned once during static initialization, so reading it needs no thread-safe guard
+	static inline const int id = nextId++;
+
 public:
 	//Returns the unique id of the Component<T>
-	static auto GetId()
+	static int GetId()
 	{
-		static auto id = nextId++;
+		assert(id < static_cast<int>(MAX_COMPONENTS) && "Too many component types, raise ECS_MAX_COMPONENTS");
 		return id;
 	}
 };
@@ -65,23 +215,105 @@ class Entity
 		class Registry* registry;
 };
 
+/////////////////////////
+// SYSTEM PHASES
+// Systems run once per frame in phase order, and in the order they were added inside a phase
+/////////////////////////
+enum class SystemPhase
+{
+	PreUpdate,
+	Simulation,
+	PostUpdate,
+	Render
+};
+
+const int NUM_SYSTEM_PHASES = 4;
+
+// How a system uses a component, systems that only read the same components can run at the same time
+enum class ComponentAccess
+{
+	Read,
+	Write
+};
+
+// Per-frame data handed to every system (see Game/FrameContext.h)
+struct FrameContext;
+
+// Readable name of a system or component type, without the compiler's decorations
+std::string GetTypeName(const std::type_info& type);
+
 class System
 {
 	private:
+		std::string name;
+		SystemPhase phase = SystemPhase::Simulation;
+
+		// Time spent in Run(), filled by the registry
+		double lastRunMilliseconds = 0.0;
+		double totalRunMilliseconds = 0.0;
+		int runCount = 0;
+
 		Signature componentSignature;
+
+		// Components the system reads and writes while it runs
+		Signature readSignature;
+		Signature writeSignature;
+
 		std::vector<Entity> entities;
 
+		// [index = entity id] position of the entity in the entities list, or -1 if it is not a member
+		std::vector<int> entityIdToIndex;
+
+		// Bumped when an entity joins or leaves the system, or a member gains or loses a component the system
+		// uses without requiring it
+		int membershipVersion = 0;
+
 	public:
 		System() = default;
-		~System() = default;
+		virtual ~System() = default;
+
+		// Entry point called by the registry once per frame in the system's phase
+		virtual void Run(FrameContext&) {}
+
+		const std::string& GetName() const { return name; }
+		SystemPhase GetPhase() const { return phase; }
+		double GetLastRunMilliseconds() const { return lastRunMilliseconds; }
+		double GetAverageRunMilliseconds() const { return runCount ? totalRunMilliseconds / runCount : 0.0; }
+		double GetTotalRunMilliseconds() const { return totalRunMilliseconds; }
 
 		void AddEntityToSystem(Entity entity);
 		void RemoveEntityFromSystem(Entity entity);
-		std::vector<Entity> GetSystemEntities() const;
+		void RemoveEntitiesFromSystem(const std::vector<Entity>& entitiesToRemove);
+		bool HasEntity(Entity entity) const;
+		// The list is only modified by Registry::Update(), entities created or killed
+		// while it is being iterated are queued and applied on the next update
+		const std::vector<Entity>& GetSystemEntities() const;
 		const Signature& GetComponentSignature() const;
+		// Lets a system keep what it derives from its members until the next change, instead of every frame
+		int GetMembershipVersion() const { return membershipVersion; }
+
+		// Bytes held by the membership lists
+		size_t GetUsedBytes() const;
+		size_t GetCapacityBytes() const;
+
+		// True when the two systems cannot run at the same time, one writing a component the other uses
+		bool ConflictsWith(const System& other) const;
 
 		// Defines the component type that entities must have to be considered by the system
-		template <typename TComponent> void RequireComponent();
+		// Components are written by default, declare the ones the system only reads so it can run alongside other readers
+		template <typename TComponent> void RequireComponent(ComponentAccess access = ComponentAccess::Write);
+
+		// Declares a component the system uses without requiring it from its entities
+		template <typename TComponent> void UseComponent(ComponentAccess access);
+
+	protected:
+		// Hold a pointer to the registry that owns the system, set by Registry::AddSystem()
+		class Registry* registry = nullptr;
+
+		// Defines when the system runs in the frame, systems are simulation systems by default
+		void SetPhase(SystemPhase systemPhase) { phase = systemPhase; }
+
+		friend class Registry;
 };
 
 
@@ -92,64 +324,651 @@ class IPool
 {
 public:
 	virtual ~IPool() {}
+	virtual void RemoveEntityFromPool(int entityId) = 0;
+	virtual const std::vector<int>& GetEntityIds() const = 0;
+
+	virtual std::string GetComponentName() const = 0;
+	// Bytes of the live components and lookup entries, and bytes the vectors have allocated
+	virtual size_t GetUsedBytes() const = 0;
+	virtual size_t GetCapacityBytes() const = 0;
 };
 
 /////////////////////////////////////////////////////
-// A pool is just a vector of objects of type T
-// Wrapper around entity?
+// A pool is a sparse set of objects of type T
+// data      [dense index] = component of the entity that owns it
+// entities  [dense index] = id of the entity that owns data[dense index]
+// entityIdToIndex [entity id] = dense index, or -1 when the entity does not own a T
+// Iterating the pool only touches live components, memory grows with the
+// number of owners and add/remove are O(1) (removal swaps the last element in the hole)
 /////////////////////////////////////////////////////
 template<typename T>
 class Pool: public IPool
 {
 private:
 	std::vector<T> data;
+	std::vector<int> entities;
+	std::vector<int> entityIdToIndex;
 
 public:
-	Pool(int size = 100)
+	Pool(int capacity = 100)
 	{
-		data.resize(size);
+		data.reserve(capacity);
+		entities.reserve(capacity);
 	}
 	virtual ~Pool() = default;
 
-	bool isEmpty() const
+	bool IsEmpty() const
 	{
 		return data.empty();
 	}
 
 	int GetSize() const
 	{
-		return data.size();
+		return static_cast<int>(data.size());
 	}
 
-	void Resize(int n)
+	void Clear()
 	{
-		data.resize(n);
+		data.clear();
+		entities.clear();
+		entityIdToIndex.clear();
 	}
 
-	void Clear()
+	// Makes room for n more components owned by entities with ids up to maxEntityId
+	void Reserve(int n, int maxEntityId)
 	{
-		data.clear();
+		data.reserve(data.size() + n);
+		entities.reserve(entities.size() + n);
+		if (maxEntityId >= static_cast<int>(entityIdToIndex.size()))
+		{
+			entityIdToIndex.resize(maxEntityId + 1, -1);
+		}
 	}
 
-	void Add(T object)
+	bool Contains(int entityId) const
 	{
-		data.push_back(object);
+		return entityId < static_cast<int>(entityIdToIndex.size()) && entityIdToIndex[entityId] != -1;
 	}
 
-	void Set(int index, T object)
+	void Set(int entityId, T object)
 	{
-		data[index] = object;
+		if (Contains(entityId))
+		{
+			// If the entity already has this component, simply replace it
+			data[entityIdToIndex[entityId]] = std::move(object);
+			return;
+		}
+
+		if (entityId >= static_cast<int>(entityIdToIndex.size()))
+		{
+			entityIdToIndex.resize(entityId + 1, -1);
+		}
+
+		entityIdToIndex[entityId] = static_cast<int>(data.size());
+		entities.push_back(entityId);
+		data.push_back(std::move(object));
 	}
 
-	T& Get(int index)
+	void Remove(int entityId)
 	{
-		return static_cast<T&>(data[index]);
+		if (!Contains(entityId))
+		{
+			return;
+		}
+
+		// Move the last element into the removed slot to keep the arrays packed
+		const int indexOfRemoved = entityIdToIndex[entityId];
+		const int indexOfLast = static_cast<int>(data.size()) - 1;
+		if (indexOfRemoved != indexOfLast)
+		{
+			const int entityIdOfLast = entities[indexOfLast];
+			data[indexOfRemoved] = std::move(data[indexOfLast]);
+			entities[indexOfRemoved] = entityIdOfLast;
+			entityIdToIndex[entityIdOfLast] = indexOfRemoved;
+		}
+
+		entityIdToIndex[entityId] = -1;
+		data.pop_back();
+		entities.pop_back();
 	}
 
+	void RemoveEntityFromPool(int entityId) override
+	{
+		Remove(entityId);
+	}
+
+	T& Get(int entityId)
+	{
+		return data[entityIdToIndex[entityId]];
+	}
+
+	// Dense access, [index] is a position in the packed array and not an entity id
 	T& operator [](unsigned int index)
 	{
 		return data[index];
 	}
+
+	int GetEntityId(unsigned int index) const
+	{
+		return entities[index];
+	}
+
+	const std::vector<int>& GetEntityIds() const override
+	{
+		return entities;
+	}
+
+	std::string GetComponentName() const override
+	{
+		return GetTypeName(typeid(T));
+	}
+
+	size_t GetUsedBytes() const override
+	{
+		return data.size() * sizeof(T) + entities.size() * sizeof(int) + entityIdToIndex.size() * sizeof(int);
+	}
+
+	size_t GetCapacityBytes() const override
+	{
+		return data.capacity() * sizeof(T) + entities.capacity() * sizeof(int) + entityIdToIndex.capacity() * sizeof(int);
+	}
+};
+
+/////////////////////////////////////////////////////
+// Archetype storage
+// Alternative to the component pools: entities that have the same signature
+// live together in an archetype, stored in fixed-size chunks where every
+// component type gets its own contiguous column (structure of arrays).
+// Views walk whole chunks without any per-entity lookup, adding or removing
+// a component moves the entity to the archetype of its new signature.
+/////////////////////////////////////////////////////
+enum class StorageMode
+{
+	SparseSet,
+	Archetype
+};
+
+const size_t ARCHETYPE_CHUNK_SIZE = 16 * 1024;
+
+// Type-erased operations the archetypes need to move components between chunks
+struct ComponentInfo
+{
+	std::string name;
+	size_t size = 0;
+	size_t alignment = 0;
+	void (*moveConstruct)(void* destination, void* source) = nullptr;
+	void (*destroy)(void* component) = nullptr;
+};
+
+template <typename T>
+ComponentInfo MakeComponentInfo()
+{
+	ComponentInfo info;
+	info.name = GetTypeName(typeid(T));
+	info.size = sizeof(T);
+	info.alignment = alignof(T);
+	info.moveConstruct = [](void* destination, void* source) { new (destination) T(std::move(*static_cast<T*>(source))); };
+	info.destroy = [](void* component) { static_cast<T*>(component)->~T(); };
+	return info;
+}
+
+struct alignas(64) ArchetypeChunk
+{
+	unsigned char bytes[ARCHETYPE_CHUNK_SIZE];
+};
+
+class Archetype
+{
+private:
+	Signature signature;
+
+	// Columns of a chunk: the entity ids first, then one column per component type
+	std::vector<int> componentIds;
+	std::vector<const ComponentInfo*> componentInfos;
+	std::vector<size_t> columnOffsets;
+
+	// [index = component id] column of the component, or -1 if the archetype does not have it
+	std::vector<int> componentColumns;
+
+	int chunkCapacity = 0;
+	int numEntities = 0;
+	std::vector<std::unique_ptr<ArchetypeChunk>> chunks;
+
+	// Archetypes reached by adding/removing one component [index = component id], filled lazily
+	std::vector<Archetype*> addEdges;
+	std::vector<Archetype*> removeEdges;
+
+	friend class ArchetypeStorage;
+
+public:
+	Archetype(const Signature& signature, const std::vector<ComponentInfo>& infos);
+	~Archetype();
+	Archetype(const Archetype&) = delete;
+	Archetype& operator =(const Archetype&) = delete;
+
+	const Signature& GetSignature() const { return signature; }
+	int GetNumEntities() const { return numEntities; }
+	int GetNumChunks() const { return static_cast<int>(chunks.size()); }
+	int GetChunkCapacity() const { return chunkCapacity; }
+
+	// "TransformComponent, RigidBodyComponent"
+	std::string GetName() const;
+	size_t GetUsedBytes() const;
+	size_t GetCapacityBytes() const { return chunks.size() * sizeof(ArchetypeChunk); }
+
+	// Number of entities stored in a chunk, only the last one may be partially filled
+	int GetChunkCount(int chunkIndex) const
+	{
+		return chunkIndex < GetNumChunks() - 1 ? chunkCapacity : numEntities - chunkIndex * chunkCapacity;
+	}
+
+	int* GetEntityIds(int chunkIndex)
+	{
+		return reinterpret_cast<int*>(chunks[chunkIndex]->bytes);
+	}
+
+	void* GetColumn(int chunkIndex, int componentId)
+	{
+		const int column = componentColumns[componentId];
+		return chunks[chunkIndex]->bytes + columnOffsets[column];
+	}
+
+	void* GetComponent(int row, int componentId)
+	{
+		const int column = componentColumns[componentId];
+		return chunks[row / chunkCapacity]->bytes + columnOffsets[column] + (row % chunkCapacity) * componentInfos[column]->size;
+	}
+
+	bool HasComponent(int componentId) const
+	{
+		return componentColumns[componentId] != -1;
+	}
+
+	// Appends a row for the entity and returns it, the component storage of the row is left uninitialized
+	int AllocateRow(int entityId);
+
+	// Destroys the components of the row and fills it with the last row
+	// Returns the id of the entity that was moved into the row, or -1 if none was
+	int RemoveRow(int row);
+};
+
+class ArchetypeStorage
+{
+private:
+	struct EntityLocation
+	{
+		Archetype* archetype = nullptr;
+		int row = -1;
+	};
+
+	// [index = component id]
+	std::vector<ComponentInfo> componentInfos;
+
+	std::vector<std::unique_ptr<Archetype>> archetypes;
+
+	// [index = entity id]
+	std::vector<EntityLocation> entityLocations;
+
+	Archetype* GetOrCreateArchetype(const Signature& signature);
+	Archetype* GetArchetypeWith(Archetype* archetype, int componentId);
+	Archetype* GetArchetypeWithout(Archetype* archetype, int componentId);
+
+	// Moves the entity into the destination archetype, carrying over the components both archetypes have
+	// Returns the new row of the entity
+	int MoveEntity(int entityId, Archetype* destination);
+
+public:
+	ArchetypeStorage() : componentInfos(MAX_COMPONENTS) {}
+
+	template <typename TComponent>
+	void AddComponent(int entityId, int componentId, TComponent component);
+
+	// Places new entities that have no components yet straight into the archetype of the given components
+	template <typename ...TComponents>
+	void AddEntities(const std::vector<Entity>& entities, const TComponents& ...prototypes);
+
+	void RemoveComponent(int entityId, int componentId);
+	void* GetComponent(int entityId, int componentId) const;
+	void RemoveEntity(int entityId);
+
+	const std::vector<std::unique_ptr<Archetype>>& GetArchetypes() const { return archetypes; }
+};
+
+template <typename TComponent>
+void ArchetypeStorage::AddComponent(int entityId, int componentId, TComponent component)
+{
+	if (!componentInfos[componentId].size)
+	{
+		componentInfos[componentId] = MakeComponentInfo<TComponent>();
+	}
+
+	if (entityId >= static_cast<int>(entityLocations.size()))
+	{
+		entityLocations.resize(entityId + 1);
+	}
+
+	const EntityLocation& location = entityLocations[entityId];
+	if (location.archetype && location.archetype->HasComponent(componentId))
+	{
+		// If the entity already has this component, simply replace it
+		*static_cast<TComponent*>(location.archetype->GetComponent(location.row, componentId)) = std::move(component);
+		return;
+	}
+
+	Archetype* destination = GetArchetypeWith(location.archetype, componentId);
+	const int row = MoveEntity(entityId, destination);
+	new (destination->GetComponent(row, componentId)) TComponent(std::move(component));
+}
+
+template <typename ...TComponents>
+void ArchetypeStorage::AddEntities(const std::vector<Entity>& entities, const TComponents& ...prototypes)
+{
+	Signature signature;
+	((componentInfos[Component<TComponents>::GetId()] = MakeComponentInfo<TComponents>(), signature.set(Component<TComponents>::GetId())), ...);
+	Archetype* archetype = GetOrCreateArchetype(signature);
+
+	int maxEntityId = -1;
+	for (auto entity : entities)
+	{
+		maxEntityId = std::max(maxEntityId, entity.GetId());
+	}
+	if (maxEntityId >= static_cast<int>(entityLocations.size()))
+	{
+		entityLocations.resize(maxEntityId + 1);
+	}
+
+	for (auto entity : entities)
+	{
+		const int row = archetype->AllocateRow(entity.GetId());
+		(new (archetype->GetComponent(row, Component<TComponents>::GetId())) TComponents(prototypes), ...);
+		entityLocations[entity.GetId()].archetype = archetype;
+		entityLocations[entity.GetId()].row = row;
+	}
+}
+
+// Tuning of ComponentView::ParallelEach()
+struct ParallelOptions
+{
+	// Entities handed to a worker at a time, rounded up to a multiple of ENTITIES_PER_CACHE_LINE_RUN
+	size_t chunkSize = 4096;
+
+	// Threads sharing the work, the calling thread included (0 = every thread of the job system)
+	int maxThreads = 0;
+
+	// Below this many entities the view is iterated on the calling thread only
+	size_t serialThreshold = 16384;
+};
+
+// 64 consecutive components of any type fill a whole number of 64 byte cache lines, so chunks of a multiple
+// of 64 entities reduce the lines two workers write at once. It does not rule false sharing out: the pool
+// storage is not 64-byte aligned, so a line can still straddle two chunks, and the other pools of a view
+// are written through Get(entityId) in whatever order the driving pool holds the entities
+const size_t ENTITIES_PER_CACHE_LINE_RUN = 64;
+
+/////////////////////////////////////////////////////
+// ComponentView
+// A view resolves the storage of the requested components once and yields
+// (Entity, T1&, T2&, ...) tuples for every entity that owns all the components.
+// With component pools it walks the packed entity list of the smallest pool,
+// with archetypes it walks the chunks of every matching archetype column by column.
+// Example: for (auto [entity, transform, rigidBody] : registry->View<TransformComponent, RigidBodyComponent>())
+// Components must not be added/removed while a view is being iterated.
+/////////////////////////////////////////////////////
+template <typename ...TComponents>
+class ComponentView
+{
+private:
+	// A run of entities whose components are stored in contiguous columns
+	struct Block
+	{
+		const int* entityIds;
+		size_t count;
+		std::tuple<TComponents*...> columns;
+	};
+
+	class Registry* registry;
+	bool isChunked = false;
+
+	// Component pools
+	std::tuple<Pool<TComponents>*...> pools;
+	const std::vector<int>* entityIds = nullptr;
+
+	// Archetype chunks
+	std::vector<Block> blocks;
+
+	bool Matches(int entityId) const
+	{
+		return (std::get<Pool<TComponents>*>(pools)->Contains(entityId) && ...);
+	}
+
+	size_t GetNumCandidates() const
+	{
+		return entityIds ? entityIds->size() : 0;
+	}
+
+public:
+	class Iterator
+	{
+	private:
+		const ComponentView* view;
+		size_t block;
+		size_t index;
+
+		void SkipNonMatching()
+		{
+			if (view->isChunked)
+			{
+				return;
+			}
+			while (index < view->GetNumCandidates() && !view->Matches((*view->entityIds)[index]))
+			{
+				index++;
+			}
+		}
+
+		Entity MakeEntity(int entityId) const
+		{
+			Entity entity(entityId);
+			entity.registry = view->registry;
+			return entity;
+		}
+
+	public:
+		Iterator(const ComponentView* view, size_t block, size_t index) : view(view), block(block), index(index)
+		{
+			SkipNonMatching();
+		}
+
+		std::tuple<Entity, TComponents&...> operator *() const
+		{
+			if (view->isChunked)
+			{
+				const Block& current = view->blocks[block];
+				return std::tuple<Entity, TComponents&...>(MakeEntity(current.entityIds[index]), std::get<TComponents*>(current.columns)[index]...);
+			}
+			const int entityId = (*view->entityIds)[index];
+			return std::tuple<Entity, TComponents&...>(MakeEntity(entityId), std::get<Pool<TComponents>*>(view->pools)->Get(entityId)...);
+		}
+
+		Iterator& operator ++()
+		{
+			index++;
+			if (view->isChunked)
+			{
+				if (index == view->blocks[block].count)
+				{
+					block++;
+					index = 0;
+				}
+				return *this;
+			}
+			SkipNonMatching();
+			return *this;
+		}
+
+		bool operator ==(const Iterator& other) const { return block == other.block && index == other.index; }
+		bool operator !=(const Iterator& other) const { return !(*this == other); }
+	};
+
+	ComponentView(class Registry* registry, Pool<TComponents>* ...componentPools) : registry(registry), pools(componentPools...)
+	{
+		// If one of the components has no pool yet, no entity can match the view
+		if ((!componentPools || ...))
+		{
+			return;
+		}
+
+		// Drive the iteration from the pool with the fewest owners
+		const IPool* smallestPool = nullptr;
+		for (const IPool* pool : { static_cast<const IPool*>(componentPools)... })
+		{
+			if (!smallestPool || pool->GetEntityIds().size() < smallestPool->GetEntityIds().size())
+			{
+				smallestPool = pool;
+			}
+		}
+		entityIds = &smallestPool->GetEntityIds();
+	}
+
+	ComponentView(class Registry* registry, const ArchetypeStorage& storage, const Signature& signature) : registry(registry), isChunked(true)
+	{
+		for (const auto& archetype : storage.GetArchetypes())
+		{
+			if (!archetype->GetSignature().Contains(signature))
+			{
+				continue;
+			}
+			for (int chunk = 0; chunk < archetype->GetNumChunks(); chunk++)
+			{
+				Block newBlock;
+				newBlock.entityIds = archetype->GetEntityIds(chunk);
+				newBlock.count = archetype->GetChunkCount(chunk);
+				newBlock.columns = std::tuple<TComponents*...>(static_cast<TComponents*>(archetype->GetColumn(chunk, Component<TComponents>::GetId()))...);
+				blocks.push_back(newBlock);
+			}
+		}
+	}
+
+	// Calls func(entity, components...) for every entity in the view
+	// Same as a range-based for, but lets the compiler turn each chunk into a tight loop
+	template <typename TFunc>
+	void Each(TFunc func) const
+	{
+		if (isChunked)
+		{
+			for (const Block& block : blocks)
+			{
+				for (size_t i = 0; i < block.count; i++)
+				{
+					Entity entity(block.entityIds[i]);
+					entity.registry = registry;
+					func(entity, std::get<TComponents*>(block.columns)[i]...);
+				}
+			}
+			return;
+		}
+
+		for (size_t i = 0; i < GetNumCandidates(); i++)
+		{
+			const int entityId = (*entityIds)[i];
+			if (Matches(entityId))
+			{
+				Entity entity(entityId);
+				entity.registry = registry;
+				func(entity, std::get<Pool<TComponents>*>(pools)->Get(entityId)...);
+			}
+		}
+	}
+
+	// Same as Each(), but the entities are split in chunks that run on the registry's job system
+	// func is called concurrently for different entities, it must only touch the components it is given
+	// Without a job system, or for small views, it falls back to Each()
+	template <typename TFunc>
+	void ParallelEach(TFunc func, const ParallelOptions& options = ParallelOptions()) const;
+
+	Iterator begin() const
+	{
+		return Iterator(this, 0, 0);
+	}
+
+	Iterator end() const
+	{
+		return isChunked ? Iterator(this, blocks.size(), 0) : Iterator(this, 0, GetNumCandidates());
+	}
+};
+
+
+
+
+/////////////////////////////////////////////////////
+// CommandBuffer
+// Records structural changes (create, kill, add/remove component) so they
+// can be requested while systems iterate, including from worker threads,
+// without touching the component storage. Components are constructed in a
+// block arena that is reused from frame to frame.
+// Registry::Update() plays the buffer back: kills are sorted and deduplicated,
+// component commands are sorted by component type and only the last command
+// recorded for a given entity and component is applied.
+// Example: registry->GetCommandBuffer().AddComponent<RigidBodyComponent>(entity, glm::vec2(10, 0));
+/////////////////////////////////////////////////////
+class CommandBuffer
+{
+private:
+	struct ComponentCommand
+	{
+		int entityId;
+		int componentId;
+		// Recording order, breaks ties between commands on the same entity and component
+		int sequence;
+		// Constructed component for an add, nullptr for a remove
+		void* component;
+		void (*apply)(class Registry& registry, int entityId, void* component);
+		void (*destroy)(void* component);
+	};
+
+	struct ArenaBlock
+	{
+		std::unique_ptr<unsigned char[]> bytes;
+		size_t size;
+		size_t used;
+	};
+
+	static constexpr size_t ARENA_BLOCK_SIZE = 16 * 1024;
+
+	class Registry* registry;
+	std::mutex mutex;
+
+	std::vector<int> entitiesToCreate;
+	std::vector<int> entitiesToKill;
+	std::vector<ComponentCommand> componentCommands;
+
+	std::vector<ArenaBlock> arena;
+	size_t currentBlock = 0;
+
+	// Returns storage for a component that stays at the same address until the buffer is cleared
+	void* Allocate(size_t size, size_t alignment);
+
+	friend class Registry;
+
+public:
+	CommandBuffer(class Registry* registry) : registry(registry) {}
+	~CommandBuffer();
+
+	// The entity id is reserved right away, the entity joins the registry on the next Update()
+	Entity CreateEntity();
+	void KillEntity(Entity entity);
+
+	template <typename TComponent, typename ...TArgs>
+	void AddComponent(Entity entity, TArgs&& ...args);
+
+	template <typename TComponent>
+	void RemoveComponent(Entity entity);
+
+	bool IsEmpty();
+
+	// Applies the component commands, dropping the ones that target killed entities (sorted)
+	void PlayComponentCommands(const std::vector<int>& killedEntityIds);
+	void Clear();
 };
 
 
@@ -165,30 +984,88 @@ private:
 
 	// Vector of component pools, each pool contains all the data for a certain component type
 	// Vector index = Component type id
-	// [Pool index = entity id]
+	// Each pool is a sparse set indexed by entity id
 	std::vector<std::shared_ptr<IPool>> componentPools;
 
+	// Which of the two layouts holds the component data, chosen when the registry is created
+	StorageMode storageMode;
+	ArchetypeStorage archetypeStorage;
+
 	// Vector of component signatures.
 	// The signature lets us know which components are turned "on" for an entity
 	// [vector index = entity id]
 	std::vector<Signature> entityComponentSignatures;
 
 
-	// Map of active systems
-	// [index = system typeid]
-	std::unordered_map<std::type_index, std::shared_ptr<System>> systems;
+	// Active systems in the order they were added
+	struct SystemEntry
+	{
+		std::type_index type;
+		std::shared_ptr<System> system;
+	};
+	std::vector<SystemEntry> systems;
+
+	// Systems of each phase in execution order
+	// [index = phase]
+	std::vector<System*> systemsByPhase[NUM_SYSTEM_PHASES];
+
+	// Dependencies between the systems of each phase, a system waits for the earlier systems it conflicts with
+	// [index = phase][index = position of the system in its phase]
+	struct SystemNode
+	{
+		int numDependencies = 0;
+		std::vector<int> dependents;
+	};
+	std::vector<SystemNode> systemGraph[NUM_SYSTEM_PHASES];
+
+	// Worker threads the systems run on, systems run one after another when there is none
+	JobSystem* jobSystem = nullptr;
+
+	void RunSystem(System& system, FrameContext& context);
+
+	// Systems that require a component, so a component change only revisits the systems it can affect
+	// [index = component id]
+	std::vector<std::vector<System*>> systemsByComponent;
+	// Systems that use a component without requiring it, told when one of their members gains or loses it
+	// [index = component id]
+	std::vector<std::vector<System*>> systemsUsingComponent;
 
-	// Set of entities that are flagged to be added of removed in the next registry Update()
-	std::set<Entity> entitiesToBeAdded;
-	std::set<Entity> entitiesToBeKilled;
+	// (entity id, component id) of the components added/removed since the last Update()
+	std::vector<std::pair<int, int>> signatureChanges;
+
+	// Entities that are waiting to be added to their systems in the next registry Update()
+	std::vector<Entity> entitiesToBeAdded;
+
+	// Structural changes requested while the systems run, entities to be killed are recorded here too
+	CommandBuffer commandBuffer;
 
 	// List of free entity ids that were previously removed
 	std::deque<int> freeIds;
 
+	// Entities created and killed since the registry was created
+	uint64_t numEntitiesCreated = 0;
+	uint64_t numEntitiesKilled = 0;
+
+	// Returns the pool of a component type without touching its reference count, or nullptr if there is none
+	template <typename TComponent>
+	Pool<TComponent>* GetPool() const;
+
+	// Returns the pool of a component type, creating it if needed
+	template <typename TComponent>
+	Pool<TComponent>* GetOrCreatePool();
+
+	// Takes the next free entity id, recycling the ids of killed entities first
+	// The command buffer can take ids from worker threads, so id allocation is guarded
+	int TakeEntityId();
+	int TakeEntityIdLocked();
+	std::mutex entityIdMutex;
+
+	friend class CommandBuffer;
+
 public:
-	Registry()
+	Registry(StorageMode storageMode = StorageMode::SparseSet) : storageMode(storageMode), systemsByComponent(MAX_COMPONENTS), systemsUsingComponent(MAX_COMPONENTS), commandBuffer(this)
 	{
-		Logger::Log("Registry constructor called");
+		Logger::Log(std::string("Registry constructor called, storing components in ") + (storageMode == StorageMode::Archetype ? "archetype chunks" : "component pools"));
 	}
 
 	~Registry()
@@ -198,9 +1075,24 @@ public:
 
 	void Update();
 
+	StorageMode GetStorageMode() const { return storageMode; }
+
 	// Entity management
 	Entity CreateEntity();
 	void KillEntity(Entity entity);
+
+	uint64_t GetNumEntitiesCreated() const { return numEntitiesCreated; }
+	uint64_t GetNumEntitiesKilled() const { return numEntitiesKilled; }
+
+	// Records structural changes to be applied on the next Update(), safe to use while systems iterate
+	CommandBuffer& GetCommandBuffer() { return commandBuffer; }
+
+	// Creates count entities at once, each one with a copy of the given components
+	// Ids, signatures and component storage are reserved up front and the
+	// entities join their systems as one batch on the next Update()
+	// Example: registry->CreateEntities(1000, TransformComponent(), RigidBodyComponent(glm::vec2(10, 0)));
+	template <typename ...TComponents>
+	std::vector<Entity> CreateEntities(int count, const TComponents& ...prototypes);
 	////////////////////////////////////////////////////////
 	
 	// Component management
@@ -215,6 +1107,10 @@ public:
 
 	template <typename TComponent>
 	TComponent& GetComponent(Entity entity) const;
+
+	// Returns a view over all the entities that own every one of the given components
+	template <typename ...TComponents>
+	ComponentView<TComponents...> View();
 	////////////////////////////////////////////////////////
 	
 	// System management
@@ -229,20 +1125,58 @@ public:
 
 	template <typename TSystem>
 	TSystem& GetSystem() const;
+
+	// Runs every system of the phase and records how long each one took
+	// With a job system, systems that do not conflict run at the same time, so they must not add/remove
+	// components or create entities directly, the command buffer is the thread-safe way to do it
+	// The render phase always runs in order on the calling thread, which owns the renderer
+	void RunPhase(SystemPhase phase, FrameContext& context);
+
+	void SetJobSystem(JobSystem* jobSystem) { this->jobSystem = jobSystem; }
+	JobSystem* GetJobSystem() const { return jobSystem; }
+
+	const std::vector<System*>& GetSystemsInPhase(SystemPhase phase) const { return systemsByPhase[static_cast<int>(phase)]; }
 	////////////////////////////////////////////////////////
 
 	// Add and remove entities from their systems
 	// Checks the component signature of an entity and add the entity to the systems that are interested in it
 	void AddEntityToSystems(Entity entity);
 	void RemoveEntityFromSystems(Entity entity);
+	void RemoveEntitiesFromSystems(const std::vector<Entity>& entities);
+
+	// Adds an entry per component pool or archetype, per system and for the registry's own bookkeeping
+	void CollectMemoryStats(MemoryReport& report) const;
+
+	// Adds or removes entities whose components changed to/from the systems that require those components
+	void UpdateSystemsMembership();
+	void RebuildSystemsByComponent();
+	void RebuildSystemsByPhase();
+
+	template <typename TSystem>
+	std::vector<SystemEntry>::const_iterator FindSystem() const;
 };
 
 // COMPONENT TEMPLATES
 template <typename TComponent>
-void System::RequireComponent()
+void System::RequireComponent(ComponentAccess access)
 {
 	const auto componentId = Component<TComponent>::GetId();
 	componentSignature.set(componentId);
+	UseComponent<TComponent>(access);
+}
+
+template <typename TComponent>
+void System::UseComponent(ComponentAccess access)
+{
+	const auto componentId = Component<TComponent>::GetId();
+	if (access == ComponentAccess::Write)
+	{
+		writeSignature.set(componentId);
+	}
+	else
+	{
+		readSignature.set(componentId);
+	}
 }
 
 template<typename TComponent, typename ...TArgs>
@@ -251,29 +1185,19 @@ void Registry::AddComponent(Entity entity, TArgs&& ...args)
 	const auto componentId = Component<TComponent>::GetId();
 	const auto entityId = entity.GetId();
 
-	if (componentId >= componentPools.size())
-	{
-		componentPools.resize(componentId + 1, nullptr);
-	}
+	TComponent newComponent(std::forward<TArgs>(args)...);
 
-	if (!componentPools[componentId])
+	if (storageMode == StorageMode::Archetype)
 	{
-		std::shared_ptr<Pool<TComponent>> newComponentPool = std::make_shared<Pool<TComponent>>();
-		componentPools[componentId] = newComponentPool;
+		archetypeStorage.AddComponent<TComponent>(entityId, componentId, std::move(newComponent));
 	}
-
-	 std::shared_ptr<Pool<TComponent>> componentPool = std::static_pointer_cast<Pool<TComponent>>(componentPools[componentId]);
-
-	if (entityId >= componentPool->GetSize())
+	else
 	{
-		componentPool->Resize(numEntities);
+		GetOrCreatePool<TComponent>()->Set(entityId, std::move(newComponent));
 	}
 
-	TComponent newComponent(std::forward<TArgs>(args)...);
-
-	componentPool->Set(entityId, newComponent);
-
 	entityComponentSignatures[entityId].set(componentId);
+	signatureChanges.emplace_back(entityId, componentId);
 
 	Logger::Log("Component id = " + std::to_string(componentId) + " was added to entity id = " + std::to_string(entityId));
 }
@@ -284,7 +1208,19 @@ void Registry::RemoveComponent(Entity entity)
 	const auto componentId = Component<TComponent>::GetId();
 	const auto entityId = entity.GetId();
 
+	// Remove the component from the component list for that entity
+	if (storageMode == StorageMode::Archetype)
+	{
+		archetypeStorage.RemoveComponent(entityId, componentId);
+	}
+	else if (componentId < static_cast<int>(componentPools.size()) && componentPools[componentId])
+	{
+		std::shared_ptr<Pool<TComponent>> componentPool = std::static_pointer_cast<Pool<TComponent>>(componentPools[componentId]);
+		componentPool->Remove(entityId);
+	}
+
 	entityComponentSignatures[entityId].set(componentId, false);
+	signatureChanges.emplace_back(entityId, componentId);
 
 	Logger::Log("Component id = " + std::to_string(componentId) + " was removed from entity id = " + std::to_string(entityId));
 }
@@ -301,11 +1237,207 @@ bool Registry::HasComponent(Entity entity) const
 template <typename TComponent>
 TComponent& Registry::GetComponent(Entity entity) const
 {
-	const auto componentId = Component<TComponent>::GetId();
 	const auto entityId = entity.GetId();
-	auto componentPool = std::static_pointer_cast<Pool<TComponent>>(componentPools[componentId]);
-	return componentPool->Get(entityId);
+
+	if (storageMode == StorageMode::Archetype)
+	{
+		return *static_cast<TComponent*>(archetypeStorage.GetComponent(entityId, Component<TComponent>::GetId()));
+	}
+	return GetPool<TComponent>()->Get(entityId);
+}
+
+template <typename TComponent>
+Pool<TComponent>* Registry::GetPool() const
+{
+	const auto componentId = Component<TComponent>::GetId();
+
+	if (componentId >= static_cast<int>(componentPools.size()))
+	{
+		return nullptr;
+	}
+	return static_cast<Pool<TComponent>*>(componentPools[componentId].get());
+}
+
+template <typename TComponent>
+Pool<TComponent>* Registry::GetOrCreatePool()
+{
+	const auto componentId = Component<TComponent>::GetId();
+
+	if (componentId >= static_cast<int>(componentPools.size()))
+	{
+		componentPools.resize(componentId + 1, nullptr);
+	}
+
+	if (!componentPools[componentId])
+	{
+		componentPools[componentId] = std::make_shared<Pool<TComponent>>();
+	}
+	return static_cast<Pool<TComponent>*>(componentPools[componentId].get());
+}
+
+template <typename ...TComponents>
+std::vector<Entity> Registry::CreateEntities(int count, const TComponents& ...prototypes)
+{
+	std::vector<Entity> entities;
+	entities.reserve(count);
+
+	Signature signature;
+	(signature.set(Component<TComponents>::GetId()), ...);
+
+	int maxEntityId = -1;
+	{
+		std::lock_guard<std::mutex> lock(entityIdMutex);
+		for (int i = 0; i < count; i++)
+		{
+			Entity entity(TakeEntityIdLocked());
+			entity.registry = this;
+			entities.push_back(entity);
+			maxEntityId = std::max(maxEntityId, entity.GetId());
+		}
+	}
+
+	if (maxEntityId >= static_cast<int>(entityComponentSignatures.size()))
+	{
+		entityComponentSignatures.resize(maxEntityId + 1);
+	}
+	for (auto entity : entities)
+	{
+		entityComponentSignatures[entity.GetId()] = signature;
+	}
+
+	if (storageMode == StorageMode::Archetype)
+	{
+		archetypeStorage.AddEntities(entities, prototypes...);
+	}
+	else
+	{
+		(GetOrCreatePool<TComponents>()->Reserve(count, maxEntityId), ...);
+		for (auto entity : entities)
+		{
+			(GetOrCreatePool<TComponents>()->Set(entity.GetId(), prototypes), ...);
+		}
+	}
+
+	entitiesToBeAdded.insert(entitiesToBeAdded.end(), entities.begin(), entities.end());
+
+	Logger::Log(std::to_string(count) + " entities created");
+
+	return entities;
+}
+
+template <typename ...TComponents>
+ComponentView<TComponents...> Registry::View()
+{
+	if (storageMode == StorageMode::Archetype)
+	{
+		Signature signature;
+		(signature.set(Component<TComponents>::GetId()), ...);
+		return ComponentView<TComponents...>(this, archetypeStorage, signature);
+	}
+	return ComponentView<TComponents...>(this, GetPool<TComponents>()...);
+}
+
+template <typename ...TComponents>
+template <typename TFunc>
+void ComponentView<TComponents...>::ParallelEach(TFunc func, const ParallelOptions& options) const
+{
+	JobSystem* jobSystem = registry->GetJobSystem();
+
+	size_t numEntities = GetNumCandidates();
+	for (const Block& block : blocks)
+	{
+		numEntities += block.count;
+	}
+
+	if (!jobSystem || jobSystem->GetNumThreads() == 1 || options.maxThreads == 1 || numEntities < options.serialThreshold)
+	{
+		Each(func);
+		return;
+	}
+
+	const size_t chunkSize = std::max<size_t>(1, (options.chunkSize + ENTITIES_PER_CACHE_LINE_RUN - 1) / ENTITIES_PER_CACHE_LINE_RUN) * ENTITIES_PER_CACHE_LINE_RUN;
+
+	if (isChunked)
+	{
+		// Archetype chunks are already cache line aligned, hand out whole chunks, enough of them to make up a chunk of work
+		const size_t blocksPerRange = std::max<size_t>(1, chunkSize * blocks.size() / numEntities);
+		jobSystem->ParallelFor(blocks.size(), blocksPerRange, [this, &func](size_t begin, size_t end)
+		{
+			for (size_t b = begin; b < end; b++)
+			{
+				const Block& block = blocks[b];
+				for (size_t i = 0; i < block.count; i++)
+				{
+					Entity entity(block.entityIds[i]);
+					entity.registry = registry;
+					func(entity, std::get<TComponents*>(block.columns)[i]...);
+				}
+			}
+		}, options.maxThreads);
+		return;
+	}
+
+	// Split the packed entity list of the smallest pool, which is also the order of its dense component array
+	jobSystem->ParallelFor(GetNumCandidates(), chunkSize, [this, &func](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			const int entityId = (*entityIds)[i];
+			if (Matches(entityId))
+			{
+				Entity entity(entityId);
+				entity.registry = registry;
+				func(entity, std::get<Pool<TComponents>*>(pools)->Get(entityId)...);
+			}
+		}
+	}, options.maxThreads);
+}
+
+//////////////////////////////////////////////////////////////////
+// COMMAND BUFFER TEMPLATES
+template <typename TComponent, typename ...TArgs>
+void CommandBuffer::AddComponent(Entity entity, TArgs&& ...args)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	ComponentCommand command;
+	command.entityId = entity.GetId();
+	command.componentId = Component<TComponent>::GetId();
+	command.sequence = static_cast<int>(componentCommands.size());
+	command.component = new (Allocate(sizeof(TComponent), alignof(TComponent))) TComponent(std::forward<TArgs>(args)...);
+	command.apply = [](Registry& registry, int entityId, void* component)
+	{
+		Entity entity(entityId);
+		entity.registry = &registry;
+		registry.AddComponent<TComponent>(entity, std::move(*static_cast<TComponent*>(component)));
+	};
+	command.destroy = [](void* component)
+	{
+		static_cast<TComponent*>(component)->~TComponent();
+	};
+	componentCommands.push_back(command);
 }
+
+template <typename TComponent>
+void CommandBuffer::RemoveComponent(Entity entity)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	ComponentCommand command;
+	command.entityId = entity.GetId();
+	command.componentId = Component<TComponent>::GetId();
+	command.sequence = static_cast<int>(componentCommands.size());
+	command.component = nullptr;
+	command.apply = [](Registry& registry, int entityId, void*)
+	{
+		Entity entity(entityId);
+		entity.registry = &registry;
+		registry.RemoveComponent<TComponent>(entity);
+	};
+	command.destroy = nullptr;
+	componentCommands.push_back(command);
+}
+
 //////////////////////////////////////////////////////////////////
 // ENTITY TEMPLATES
 template <typename TComponent, typename ...TArgs>
@@ -338,27 +1470,44 @@ template <typename TSystem, typename ...TArgs>
 void Registry::AddSystem(TArgs&& ...args)
 {
 	std::shared_ptr<TSystem> newSystem = std::make_shared<TSystem>(std::forward<TArgs>(args)...);
-	systems.insert(std::make_pair(std::type_index(typeid(TSystem)), newSystem));
+	newSystem->registry = this;
+	newSystem->name = GetTypeName(typeid(TSystem));
+	systems.push_back({ std::type_index(typeid(TSystem)), newSystem });
+	RebuildSystemsByComponent();
+	RebuildSystemsByPhase();
 }
 
 template <typename TSystem>
 void Registry::RemoveSystem()
 {
-	auto system = systems.find(std::type_index(typeid(TSystem)));
-	systems.erase(system);
+	auto system = FindSystem<TSystem>();
+	if (system != systems.end())
+	{
+		systems.erase(system);
+	}
+	RebuildSystemsByComponent();
+	RebuildSystemsByPhase();
 }
 
 template <typename TSystem>
 bool Registry::HasSystem() const
 {
-	return systems.find(std::type_index(typeid(TSystem))) != systems.end();
+	return FindSystem<TSystem>() != systems.end();
 }
 
 template <typename TSystem>
 TSystem& Registry::GetSystem() const
 {
-	auto system = systems.find(std::type_index(typeid(TSystem)));
-	return *(std::static_pointer_cast<TSystem>(system->second));
+	auto system = FindSystem<TSystem>();
+	return *(std::static_pointer_cast<TSystem>(system->system));
+}
+
+template <typename TSystem>
+std::vector<Registry::SystemEntry>::const_iterator Registry::FindSystem() const
+{
+	// There are only a handful of systems and they are no longer looked up every frame
+	const std::type_index type(typeid(TSystem));
+	return std::find_if(systems.begin(), systems.end(), [&type](const SystemEntry& entry) { return entry.type == type; });
 }
 //////////////////////////////////////////////////////////////////
 #endif 
\ No newline at end of file
@@ -2,11 +2,15 @@
 #define COLLISIONEVENT_H
 
 #include "../Logger/Logger.h"
+#include "../Profiler/Profiler.h"
 #include "Event.h"
 #include <map>
 #include <typeindex>
 #include <memory>
 #include <list>
+#include <functional>
+#include <atomic>
+#include <cstdint>
 
 class IEventCallback
 {
@@ -54,6 +58,9 @@ class EventBus
 private:
 	std::map<std::type_index, std::unique_ptr<HandlerList>> subscribers;
 
+	// Events emitted since the bus was created, systems can emit from worker threads
+	std::atomic<uint64_t> numEmittedEvents{ 0 };
+
 public:
 	EventBus()
 	{
@@ -65,6 +72,8 @@ public:
 		Logger::Log("EventBus destructor called");
 	}
 
+	uint64_t GetNumEmittedEvents() const { return numEmittedEvents.load(std::memory_order_relaxed); }
+
 	////////////////////////////////////////////////
 	// Subscribe to an event type <T>
 	// In our implementation, a listener subscribes to an event
@@ -77,7 +86,7 @@ public:
 		{
 			subscribers[typeid(TEvent)] = std::make_unique<HandlerList>();
 		}
-		auto subscriber = std::make_unique<EventCallback<TOwner, TEvent>>(ownerInstance, callbackFuncion));
+		auto subscriber = std::make_unique<EventCallback<TOwner, TEvent>>(ownerInstance, callbackFuncion);
 		subscribers[typeid(TEvent)]->push_back(std::move(subscriber));
 	}
 
@@ -90,13 +99,16 @@ public:
 	template <typename TEvent, typename ...TArgs>
 	void EmitEvent(TArgs&& ...args)
 	{
+		PROFILE_SCOPE("EventBus::EmitEvent");
+		numEmittedEvents.fetch_add(1, std::memory_order_relaxed);
 		auto handlers = subscribers[typeid(TEvent)].get();
 		if (handlers)
 		{
-			for (auto it = handlers.begin(); it != handlers.end(); it++)
+			// Build the event once, the arguments can only be forwarded once
+			TEvent event(std::forward<TArgs>(args)...);
+			for (auto it = handlers->begin(); it != handlers->end(); it++)
 			{
 				auto handler = it->get();
-				TEvent event(std::forward<TArgs>(args)...);
 				handler->Execute(event);
 			}
 		}
@@ -0,0 +1,31 @@
+#ifndef FRAMECONTEXT_H
+#define FRAMECONTEXT_H
+
+#include <cstdint>
+
+struct SDL_Renderer;
+class AssetStore;
+
+// Everything a system may need for the current frame, passed to System::Run()
+struct FrameContext
+{
+	// Seconds simulated by the current tick, always the fixed timestep
+	double deltaTime = 0.0;
+
+	// Seconds simulated since the game started
+	double simulationTime = 0.0;
+
+	// Number of simulation ticks and rendered frames since the game started
+	uint64_t tickNumber = 0;
+	uint64_t frameNumber = 0;
+
+	// How far rendering is between the previous tick (0) and the last one (1)
+	double interpolationAlpha = 1.0;
+
+	bool isDebug = false;
+
+	SDL_Renderer* renderer = nullptr;
+	AssetStore* assetStore = nullptr;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#include "FramePacer.h"
+#include <algorithm>
+
+FramePacer::FramePacer(int targetFps) : frequency(SDL_GetPerformanceFrequency())
+{
+	SetTargetFps(targetFps);
+}
+
+void FramePacer::SetTargetFps(int fps)
+{
+	targetFps = std::max(fps, 0);
+	period = targetFps > 0 ? frequency / targetFps : 0;
+	Restart();
+}
+
+void FramePacer::Restart()
+{
+	nextDeadline = 0;
+}
+
+double FramePacer::WaitForNextFrame()
+{
+	const Uint64 start = SDL_GetPerformanceCounter();
+
+	// Uncapped, or the first frame of a new cadence: start right away
+	if (period == 0 || nextDeadline == 0)
+	{
+		stats.numFrames++;
+		nextDeadline = period ? start + period : 0;
+		return 0.0;
+	}
+
+	Uint64 now = start;
+	if (now < nextDeadline)
+	{
+		// Sleep in whole milliseconds while the deadline is further than the spin margin, then spin the rest
+		const double remainingMilliseconds = ToMilliseconds(nextDeadline - now);
+		if (remainingMilliseconds > spinMilliseconds)
+		{
+			SDL_Delay(static_cast<Uint32>(remainingMilliseconds - spinMilliseconds));
+		}
+		while ((now = SDL_GetPerformanceCounter()) < nextDeadline)
+		{
+		}
+	}
+	else
+	{
+		stats.numMissedDeadlines++;
+	}
+	RecordFrameStart(now);
+
+	nextDeadline += period;
+	if (now >= nextDeadline)
+	{
+		// More than a whole period late, catching up would run several frames back to back
+		nextDeadline = now + period;
+	}
+
+	const double waitMilliseconds = ToMilliseconds(now - start);
+	stats.totalWaitMilliseconds += waitMilliseconds;
+	return waitMilliseconds;
+}
+
+void FramePacer::RecordFrameStart(Uint64 now)
+{
+	const double jitterMilliseconds = ToMilliseconds(now - nextDeadline);
+	const int bucket = std::min(static_cast<int>(jitterMilliseconds / PACING_BUCKET_MILLISECONDS), PACING_HISTOGRAM_BUCKETS - 1);
+	stats.jitterHistogram[bucket]++;
+
+	stats.numFrames++;
+	numPacedFrames++;
+	totalJitterMilliseconds += jitterMilliseconds;
+	stats.averageJitterMilliseconds = totalJitterMilliseconds / numPacedFrames;
+	stats.maxJitterMilliseconds = std::max(stats.maxJitterMilliseconds, jitterMilliseconds);
+}
+
+void FramePacer::ResetStats()
+{
+	stats = FramePacingStats();
+	numPacedFrames = 0;
+	totalJitterMilliseconds = 0.0;
+}
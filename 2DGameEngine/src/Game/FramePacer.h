@@ -0,0 +1,78 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <SDL.h>
+#include <cstdint>
+
+// Frame rate the pacer targets when none is given, 0 = uncapped
+const int DEFAULT_TARGET_FPS = 60;
+
+// Sleeping can wake up a scheduler quantum late, the end of the wait spins on the performance counter instead
+const double DEFAULT_SPIN_MILLISECONDS = 2.0;
+
+// Jitter histogram of the frame starts, in buckets of PACING_BUCKET_MILLISECONDS, the last bucket holds everything later
+const int PACING_HISTOGRAM_BUCKETS = 20;
+const double PACING_BUCKET_MILLISECONDS = 0.1;
+
+struct FramePacingStats
+{
+	uint64_t numFrames = 0;
+	// Frames whose work ran past the start of the next frame, so there was nothing to wait for
+	uint64_t numMissedDeadlines = 0;
+
+	// Jitter: how late the frames started after their deadline, missed deadlines included
+	double averageJitterMilliseconds = 0.0;
+	double maxJitterMilliseconds = 0.0;
+	uint64_t jitterHistogram[PACING_HISTOGRAM_BUCKETS] = {};
+
+	double totalWaitMilliseconds = 0.0;
+};
+
+/////////////////////////
+// FRAME PACER
+// Starts every frame on a fixed cadence measured with SDL_GetPerformanceCounter
+// The wait sleeps with SDL_Delay while the deadline is far and spins for the last DEFAULT_SPIN_MILLISECONDS
+// Deadlines advance by exactly one period, so a frame that starts a bit late does not delay the next ones;
+// after a frame longer than a whole period the cadence restarts from now instead of rushing to catch up
+// Example: framePacer.SetTargetFps(144); ... each frame: framePacer.WaitForNextFrame();
+/////////////////////////
+class FramePacer
+{
+private:
+	Uint64 frequency;
+	// In performance counter ticks, 0 when uncapped
+	Uint64 period = 0;
+	Uint64 nextDeadline = 0;
+	int targetFps = 0;
+	double spinMilliseconds = DEFAULT_SPIN_MILLISECONDS;
+	// Frames that had a deadline, the first frame of a cadence has none
+	uint64_t numPacedFrames = 0;
+	double totalJitterMilliseconds = 0.0;
+	FramePacingStats stats;
+
+	double ToMilliseconds(Uint64 counterTicks) const { return counterTicks * 1000.0 / frequency; }
+	void RecordFrameStart(Uint64 now);
+
+public:
+	FramePacer(int targetFps = DEFAULT_TARGET_FPS);
+
+	// 0 = uncapped, the frames start as soon as the previous one ends
+	void SetTargetFps(int fps);
+	int GetTargetFps() const { return targetFps; }
+	// Frame budget at the target rate, 0 when uncapped
+	double GetPeriodMilliseconds() const { return ToMilliseconds(period); }
+
+	// Longer spins are more precise but burn more CPU
+	void SetSpinMilliseconds(double milliseconds) { spinMilliseconds = milliseconds; }
+
+	// Blocks until the next frame should start, returns the milliseconds spent waiting
+	double WaitForNextFrame();
+
+	// Restarts the cadence from now, after a pause or a time mode that was not paced
+	void Restart();
+
+	const FramePacingStats& GetStats() const { return stats; }
+	void ResetStats();
+};
+
+#endif
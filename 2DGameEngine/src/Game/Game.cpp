@@ -15,14 +15,28 @@
 #include "../Systems/AnimationSystem.h"
 #include "../Systems/CollisionSystem.h"
 #include "../Systems/RenderColliderSystem.h"
+#include "../Systems/InterpolationSystem.h"
+#include "../Profiler/Profiler.h"
+#include "../Profiler/TraceRecorder.h"
+#include <imgui/imgui.h>
+#include <imgui/imgui_sdl.h>
 #include <fstream>
+#include <random>
+#include <algorithm>
 
-Game::Game()
+Game::Game(const GameOptions& options) : options(options)
 {
 	isRunning = false;
+	window = nullptr;
+	renderer = nullptr;
 	isDebug = false;
-	registry = std::make_unique<Registry>();
+	jobSystem = std::make_unique<JobSystem>(JobSystem::GetDefaultNumWorkers());
+	registry = std::make_unique<Registry>(options.storageMode);
+	registry->SetJobSystem(jobSystem.get());
 	assetStore = std::make_unique<AssetStore>();
+	eventBus = std::make_unique<EventBus>();
+	hitchLog.SetPath(options.hitchLogFile);
+	framePacer.SetTargetFps(options.targetFps);
 	Logger::Log("Game Constructor called.");
 }
 
@@ -36,6 +50,21 @@ initializing the window using sdl
 */
 void Game::Initialize()
 {
+	// Without a display only the timer is needed, nothing is drawn and no texture is created
+	if (options.isHeadless)
+	{
+		windowHeight = 600;
+		windowWidth = 800;
+		if (SDL_Init(SDL_INIT_TIMER) != 0)
+		{
+			Logger::Err("Error initializing SDL timer.");
+			return;
+		}
+		Logger::Log("Running headless");
+		isRunning = true;
+		return;
+	}
+
 	//init sdl
 	if (SDL_Init(SDL_INIT_EVERYTHING) != 0) //fails if we are running on a machine that doesn't have a gui
 	{
@@ -62,7 +91,7 @@ void Game::Initialize()
 	}
 
 	//we need a renderer to able to render something in the window
-	renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+	renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | (options.isVsync ? SDL_RENDERER_PRESENTVSYNC : 0));
 	if (!renderer)
 	{
 		std::cerr << "Error creating SDL renderer." << std::endl;
@@ -71,6 +100,10 @@ void Game::Initialize()
 
 	SDL_SetWindowFullscreen(window, SDL_WINDOW_FULLSCREEN);
 
+	// ImGui draws the debug overlays through the SDL renderer
+	ImGui::CreateContext();
+	ImGuiSDL::Initialize(renderer, windowWidth, windowHeight);
+
 	isRunning = true;
 }
 
@@ -91,6 +124,29 @@ void Game::ProcessInput() //TAKE INPUT FROM USER
 					isRunning = false;
 				if (sdlEvent.key.keysym.sym == SDLK_d)
 					isDebug = !isDebug;
+				if (sdlEvent.key.keysym.sym == SDLK_p)
+					isProfilerVisible = !isProfilerVisible;
+				if (sdlEvent.key.keysym.sym == SDLK_f)
+				{
+					// Cycle real time -> fast-forward -> unthrottled
+					if (timeMode == TimeMode::RealTime)
+						SetTimeMode(TimeMode::FastForward, fastForwardTicks);
+					else if (timeMode == TimeMode::FastForward)
+						SetTimeMode(TimeMode::Unthrottled);
+					else
+						SetTimeMode(TimeMode::RealTime);
+				}
+				if (sdlEvent.key.keysym.sym == SDLK_r)
+				{
+					// Cycle the real time frame rate 60 -> 144 -> 240 -> uncapped
+					const int rates[] = { 60, 144, 240, 0 };
+					const int numRates = sizeof(rates) / sizeof(rates[0]);
+					const int* rate = std::find(rates, rates + numRates, framePacer.GetTargetFps());
+					const int nextRate = rate == rates + numRates ? rates[0] : rates[(rate - rates + 1) % numRates];
+					framePacer.SetTargetFps(nextRate);
+					framePacer.ResetStats();
+					Logger::Log(nextRate ? "Frame rate set to " + std::to_string(nextRate) + " FPS" : std::string("Frame rate uncapped"));
+				}
 				break;
 		}
 	}
@@ -99,11 +155,15 @@ void Game::ProcessInput() //TAKE INPUT FROM USER
 void Game::LoadLevel(int level)
 {
 	// Add the system that need to be processed in our game
+	registry->AddSystem<InterpolationSystem>();
 	registry->AddSystem<MovementSystem>();
-	registry->AddSystem<RenderSystem>();
 	registry->AddSystem<AnimationSystem>();
-	registry->AddSystem<CollisionSystem>();
-	registry->AddSystem<RenderColliderSystem>();
+	registry->AddSystem<CollisionSystem>(options.broadphase, options.collisionCellSize);
+	if (!options.isHeadless)
+	{
+		registry->AddSystem<RenderSystem>();
+		registry->AddSystem<RenderColliderSystem>();
+	}
 
 	// Adding assets 
 	assetStore->AddTexture(renderer, "tank-image", "./assets/images/tank-panther-right.png");
@@ -111,6 +171,9 @@ void Game::LoadLevel(int level)
 	assetStore->AddTexture(renderer, "tilemap-image", "./assets/tilemaps/jungle.png");
 	assetStore->AddTexture(renderer, "chopper-image", "./assets/images/chopper.png");
 	assetStore->AddTexture(renderer, "radar-image", "./assets/images/radar.png");
+	assetStore->AddTexture(renderer, "tree-image", "./assets/images/tree.png");
+	assetStore->AddTexture(renderer, "takeoff-base-image", "./assets/images/takeoff-base.png");
+	assetStore->AddTexture(renderer, "landing-base-image", "./assets/images/landing-base.png");
 
 
 	// Load the tilemap
@@ -122,6 +185,11 @@ void Game::LoadLevel(int level)
 	std::fstream mapFile;
 	mapFile.open("./assets/tilemaps/jungle.map");
 
+	// Spawn all the tiles at once, then place each one and pick its part of the tilemap
+	std::vector<Entity> tiles = registry->CreateEntities(mapNumRows * mapNumCols,
+		TransformComponent(glm::vec2(0, 0), glm::vec2(tileScale, tileScale), 0.0),
+		SpriteComponent("tilemap-image", tileSize, tileSize, 0));
+
 	for (int y = 0; y < mapNumRows; y++)
 	{
 		for (int x = 0; x < mapNumCols; x++)
@@ -133,13 +201,35 @@ void Game::LoadLevel(int level)
 			int srcRectX = std::atoi(&ch) * tileSize;
 			mapFile.ignore();
 
-			Entity tile = registry->CreateEntity();
-			tile.AddComponent<TransformComponent>(glm::vec2(x * (tileScale * tileSize), y * (tileScale * tileSize)), glm::vec2(tileScale, tileScale), 0.0);
-			tile.AddComponent<SpriteComponent>("tilemap-image", tileSize, tileSize, 0,srcRectX, srcRectY);
+			Entity tile = tiles[y * mapNumCols + x];
+			tile.GetComponent<TransformComponent>().position = glm::vec2(x * (tileScale * tileSize), y * (tileScale * tileSize));
+			auto& sprite = tile.GetComponent<SpriteComponent>();
+			sprite.srcRect.x = srcRectX;
+			sprite.srcRect.y = srcRectY;
 		}
 	}
 	mapFile.close();
 
+	// Scenery: without a rigid body their colliders are static, baked once by the collision system
+	Entity takeoffBase = registry->CreateEntity();
+	takeoffBase.AddComponent<TransformComponent>(glm::vec2(240.0, 115.0), glm::vec2(1, 1), 0);
+	takeoffBase.AddComponent<SpriteComponent>("takeoff-base-image", 32, 32, 1);
+	takeoffBase.AddComponent<BoxColliderComponent>(32, 32);
+
+	Entity landingBase = registry->CreateEntity();
+	landingBase.AddComponent<TransformComponent>(glm::vec2(640.0, 460.0), glm::vec2(1, 1), 0);
+	landingBase.AddComponent<SpriteComponent>("landing-base-image", 32, 32, 1);
+	landingBase.AddComponent<BoxColliderComponent>(32, 32);
+
+	const glm::vec2 treePositions[] = { glm::vec2(300, 10), glm::vec2(120, 200), glm::vec2(136, 210), glm::vec2(420, 330), glm::vec2(700, 150) };
+	for (const auto& position : treePositions)
+	{
+		Entity tree = registry->CreateEntity();
+		tree.AddComponent<TransformComponent>(position, glm::vec2(1, 1), 0);
+		tree.AddComponent<SpriteComponent>("tree-image", 16, 32, 2);
+		tree.AddComponent<BoxColliderComponent>(16, 32);
+	}
+
 	// Create an entity
 	Entity chopper = registry->CreateEntity();
 	chopper.AddComponent<TransformComponent>(glm::vec2(10.0, 10.0), glm::vec2(1, 1), 0);
@@ -166,63 +256,462 @@ void Game::LoadLevel(int level)
 	truck.AddComponent<BoxColliderComponent>(32, 32);
 }
 
-void Game::Setup() //initialize game objects
+void Game::LoadStressScene(int numEntities)
 {
-	LoadLevel(1);
+	registry->AddSystem<InterpolationSystem>();
+	registry->AddSystem<MovementSystem>();
+	registry->AddSystem<AnimationSystem>();
+	registry->AddSystem<CollisionSystem>(options.broadphase, options.collisionCellSize);
+	if (!options.isHeadless)
+	{
+		registry->AddSystem<RenderSystem>();
+		registry->AddSystem<RenderColliderSystem>();
+	}
+
+	assetStore->AddTexture(renderer, "chopper-image", "./assets/images/chopper.png");
+
+	// Choppers flying in every direction, the same ones on every run
+	std::vector<Entity> choppers = registry->CreateEntities(numEntities,
+		TransformComponent(glm::vec2(0, 0), glm::vec2(1, 1), 0.0),
+		RigidBodyComponent(glm::vec2(0, 0)),
+		SpriteComponent("chopper-image", 32, 32, 2),
+		AnimationComponent(2, 15, true));
+
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> x(0.0f, static_cast<float>(windowWidth));
+	std::uniform_real_distribution<float> y(0.0f, static_cast<float>(windowHeight));
+	std::uniform_real_distribution<float> speed(-100.0f, 100.0f);
+	for (auto chopper : choppers)
+	{
+		auto& transform = chopper.GetComponent<TransformComponent>();
+		transform.position = transform.previousPosition = glm::vec2(x(random), y(random));
+		chopper.GetComponent<RigidBodyComponent>().velocity = glm::vec2(speed(random), speed(random));
+	}
+
+	// Only one chopper in a hundred collides
+	for (size_t i = 0; i < choppers.size(); i += 100)
+	{
+		choppers[i].AddComponent<BoxColliderComponent>(32, 32);
+	}
+
+	Logger::Log("Stress scene loaded with " + std::to_string(numEntities) + " entities");
 }
 
-void Game::Update() //UPDATE GAME OBJECTS BASED ON INPUT FROM USER
+void Game::Setup() //initialize game objects
 {
-	// IF WE ARE TOO FAST, WE WAIT IN THIS LOOP
-	int timeToWait = MILLISECS_PER_FRAME - (SDL_GetTicks() - millisecsPreviousFrame);
-	if (timeToWait > 0 && timeToWait <= MILLISECS_PER_FRAME)
+	if (options.scene == "stress")
+	{
+		LoadStressScene(options.numStressEntities);
+	}
+	else if (options.scene == "jungle")
+	{
+		LoadLevel(1);
+	}
+	else
 	{
-		SDL_Delay(timeToWait);
+		Logger::Err("Unknown scene " + options.scene);
+		isRunning = false;
 	}
+	previousFrameTime = std::chrono::steady_clock::now();
+}
 
-	// The difference in ticks since the last frame, converted to seconds
-	double deltaTime = (SDL_GetTicks() - millisecsPreviousFrame) / 1000.0;
+void Game::SetTimeMode(TimeMode mode, int ticksPerFrame)
+{
+	timeMode = mode;
+	fastForwardTicks = std::max(ticksPerFrame, 1);
+	// Start the new mode from the current state instead of catching up on the time spent in the old one
+	accumulator = 0.0;
+	framePacer.Restart();
+
+	const char* modeNames[] = { "real time", "fast-forward", "unthrottled" };
+	std::string message = std::string("Time mode set to ") + modeNames[static_cast<int>(mode)];
+	if (mode == TimeMode::FastForward)
+	{
+		message += " (" + std::to_string(fastForwardTicks) + " ticks per frame)";
+	}
+	Logger::Log(message);
+}
 
-	//Store previous frame time
-	millisecsPreviousFrame = SDL_GetTicks();
+// Advances the simulation by one fixed step
+void Game::Tick()
+{
+	PROFILE_SCOPE("Game::Tick");
 
 	// Update the registry to process the entities that are waiting to be created/deleted
-	registry->Update();
+	{
+		PROFILE_SCOPE("Registry::Update");
+		registry->Update();
+	}
+
+	frameContext.deltaTime = SECONDS_PER_TICK;
+	frameContext.tickNumber++;
+	frameContext.isDebug = isDebug;
+	frameContext.renderer = renderer;
+	frameContext.assetStore = assetStore.get();
+
+	// Invoke all the systems that need to update, phase after phase
+	registry->RunPhase(SystemPhase::PreUpdate, frameContext);
+	registry->RunPhase(SystemPhase::Simulation, frameContext);
+	registry->RunPhase(SystemPhase::PostUpdate, frameContext);
+
+	frameContext.simulationTime += SECONDS_PER_TICK;
+}
+
+void Game::Update() //UPDATE GAME OBJECTS BASED ON INPUT FROM USER
+{
+	PROFILE_SCOPE("Game::Update");
 
-	// Invoke all the systems that need to update
-	registry->GetSystem<MovementSystem>().Update(deltaTime);
-	registry->GetSystem<AnimationSystem>().Update();
-	registry->GetSystem<CollisionSystem>().Update();
+	// IF WE ARE TOO FAST, WE WAIT, only real time is paced to the target frame rate
+	if (timeMode == TimeMode::RealTime)
+	{
+		frameWaitMilliseconds = framePacer.WaitForNextFrame();
+	}
+
+	// Wall time elapsed since the previous frame
+	const auto frameStart = std::chrono::steady_clock::now();
+	const double frameSeconds = std::min(std::chrono::duration<double>(frameStart - previousFrameTime).count(), MAX_FRAME_SECONDS);
+	previousFrameTime = frameStart;
+
+	switch (timeMode)
+	{
+		case TimeMode::RealTime:
+			// Run as many fixed ticks as the elapsed time holds, the remainder carries over to the next frame
+			accumulator += frameSeconds;
+			while (accumulator >= SECONDS_PER_TICK)
+			{
+				Tick();
+				accumulator -= SECONDS_PER_TICK;
+			}
+			frameContext.interpolationAlpha = accumulator / SECONDS_PER_TICK;
+			break;
+
+		case TimeMode::FastForward:
+			for (int i = 0; i < fastForwardTicks; i++)
+			{
+				Tick();
+			}
+			frameContext.interpolationAlpha = 1.0;
+			break;
+
+		case TimeMode::Unthrottled:
+			// Tick until the frame budget is spent, then show the last state
+			do
+			{
+				Tick();
+			} while (std::chrono::steady_clock::now() - frameStart < std::chrono::milliseconds(MILLISECS_PER_FRAME));
+			frameContext.interpolationAlpha = 1.0;
+			break;
+	}
 }
 
 void Game::Render() //UPDATE SCREEN
 {
+	PROFILE_SCOPE("Game::Render");
+
 	SDL_SetRenderDrawColor(renderer, 21, 21, 21, 255); //background color and transparency
 	SDL_RenderClear(renderer);
 
-	registry->GetSystem<RenderSystem>().Update(renderer,assetStore);
-	if (isDebug)
+	frameContext.frameNumber++;
+	frameContext.isDebug = isDebug;
+	frameContext.renderer = renderer;
+	frameContext.assetStore = assetStore.get();
+	registry->RunPhase(SystemPhase::Render, frameContext);
+
+	if (isProfilerVisible)
 	{
-		registry->GetSystem<RenderColliderSystem>().Update(renderer);
+		RenderProfilerOverlay();
 	}
 
+	PROFILE_SCOPE("SDL_RenderPresent");
 	SDL_RenderPresent(renderer);
 }
 
+void Game::RenderProfilerOverlay()
+{
+	ImGuiIO& io = ImGui::GetIO();
+	io.DisplaySize = ImVec2(static_cast<float>(windowWidth), static_cast<float>(windowHeight));
+	io.DeltaTime = static_cast<float>(std::max(frameContext.deltaTime, 1.0 / 1000.0));
+
+	int mouseX, mouseY;
+	const int buttons = SDL_GetMouseState(&mouseX, &mouseY);
+	io.MousePos = ImVec2(static_cast<float>(mouseX), static_cast<float>(mouseY));
+	io.MouseDown[0] = buttons & SDL_BUTTON(SDL_BUTTON_LEFT);
+	io.MouseDown[1] = buttons & SDL_BUTTON(SDL_BUTTON_RIGHT);
+
+	ImGui::NewFrame();
+	profilerOverlay.Draw(*registry, framePacer, memoryReport, memoryTracker.GetTotalHighWaterBytes());
+	ImGui::Render();
+	ImGuiSDL::Render(ImGui::GetDrawData());
+}
+
 void Game::Run()
 {
+	// Tracing from the first frame also records the level loading
+	if (!options.traceFile.empty() && options.traceFirstFrame == 0)
+	{
+		StartTrace();
+	}
+
 	Setup();
+	if (options.isHeadless)
+	{
+		RunHeadless();
+		return;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
 	while (isRunning) //GAME LOOP
 	{
-		ProcessInput();
-		Update();
-		Render();
+		BeginFrame();
+		{
+			PROFILE_SCOPE("Game::Run");
+			ProcessInput();
+			Update();
+			Render();
+		}
+		EndFrame();
+
+		if (options.numFrames > 0 && frameContext.frameNumber >= static_cast<uint64_t>(options.numFrames))
+		{
+			isRunning = false;
+		}
+	}
+	StopTrace();
+	const double elapsedMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	LogSystemTimings(elapsedMilliseconds);
+	if (!options.statsFile.empty())
+	{
+		CollectMemoryStats();
+		WriteStats(options.statsFile, elapsedMilliseconds);
+	}
+}
+
+void Game::BeginFrame()
+{
+	if (!options.traceFile.empty() && !TraceRecorder::IsRecording() && frameContext.frameNumber == static_cast<uint64_t>(options.traceFirstFrame))
+	{
+		StartTrace();
 	}
+	Profiler::BeginFrame();
+	frameStartCounters = ReadFrameCounters();
+	frameWaitMilliseconds = 0.0;
+}
+
+void Game::EndFrame()
+{
+	// Walking every pool and texture costs, only the overlay needs the memory every frame,
+	// the stats file samples it for its high-water marks
+	const bool isMemorySampled = !options.statsFile.empty() && frameContext.frameNumber % MEMORY_STATS_SAMPLE_FRAMES == 0;
+	if (isProfilerVisible || isMemorySampled)
+	{
+		CollectMemoryStats();
+	}
+	Profiler::EndFrame();
+	CheckFrameBudget();
+	// frameNumber already counts the frame that just ended
+	if (TraceRecorder::IsRecording() && options.traceLastFrame >= 0 && frameContext.frameNumber > static_cast<uint64_t>(options.traceLastFrame))
+	{
+		StopTrace();
+	}
+}
+
+FrameCounters Game::ReadFrameCounters() const
+{
+	FrameCounters counters;
+	counters.tickNumber = frameContext.tickNumber;
+	counters.numEntitiesCreated = registry->GetNumEntitiesCreated();
+	counters.numEntitiesKilled = registry->GetNumEntitiesKilled();
+	counters.numEvents = eventBus->GetNumEmittedEvents();
+	counters.numAssetsLoaded = assetStore->GetNumTexturesLoaded();
+	return counters;
+}
+
+// Writes the frame that just ended to the hitch log if its work went over the frame budget
+void Game::CheckFrameBudget()
+{
+	// Fast-forward and unthrottled frames are slow on purpose, headless frames are not paced and have no budget
+	if (!hitchLog.IsEnabled() || options.isHeadless || timeMode != TimeMode::RealTime)
+	{
+		return;
+	}
+
+	const ProfileFrame& frame = Profiler::GetLastFrame();
+	const double workMilliseconds = frame.frameMilliseconds - frameWaitMilliseconds;
+	const double budgetMilliseconds = framePacer.GetTargetFps() > 0 ? framePacer.GetPeriodMilliseconds() : MILLISECS_PER_FRAME;
+	if (workMilliseconds <= budgetMilliseconds)
+	{
+		return;
+	}
+
+	const FrameCounters counters = ReadFrameCounters();
+	HitchRecord record;
+	record.frameNumber = frameContext.frameNumber - 1;
+	record.tickNumber = frameContext.tickNumber;
+	record.frameMilliseconds = static_cast<float>(workMilliseconds);
+	record.numTicks = static_cast<uint32_t>(counters.tickNumber - frameStartCounters.tickNumber);
+	record.numEntitiesCreated = static_cast<uint32_t>(counters.numEntitiesCreated - frameStartCounters.numEntitiesCreated);
+	record.numEntitiesKilled = static_cast<uint32_t>(counters.numEntitiesKilled - frameStartCounters.numEntitiesKilled);
+	record.numEvents = static_cast<uint32_t>(counters.numEvents - frameStartCounters.numEvents);
+	record.numAssetsLoaded = static_cast<uint32_t>(counters.numAssetsLoaded - frameStartCounters.numAssetsLoaded);
+
+	// A scope runs once per tick or per system batch, sum its runs
+	const int numSamples = std::min(frame.numSamples.load(std::memory_order_relaxed), PROFILER_MAX_SAMPLES_PER_FRAME);
+	for (int i = 0; i < numSamples; i++)
+	{
+		const ProfileSample& sample = frame.samples[i];
+		auto scope = std::find_if(record.scopes.begin(), record.scopes.end(), [&sample](const HitchScope& s) { return s.name == sample.name; });
+		if (scope == record.scopes.end())
+		{
+			record.scopes.push_back({ sample.name, 0.0f });
+			scope = record.scopes.end() - 1;
+		}
+		scope->milliseconds += static_cast<float>(sample.milliseconds);
+	}
+	std::sort(record.scopes.begin(), record.scopes.end(), [](const HitchScope& a, const HitchScope& b) { return a.milliseconds > b.milliseconds; });
+
+	hitchLog.Append(record);
+}
+
+void Game::CollectMemoryStats()
+{
+	PROFILE_SCOPE("Game::CollectMemoryStats");
+	memoryReport.Clear();
+	registry->CollectMemoryStats(memoryReport);
+	assetStore->CollectMemoryStats(memoryReport);
+	CollectLoggerMemoryStats(memoryReport);
+	memoryTracker.Track(memoryReport);
+}
+
+void Game::StartTrace()
+{
+	TraceRecorder::SetThreadName("Main thread");
+	TraceRecorder::Start();
+}
+
+void Game::StopTrace()
+{
+	if (TraceRecorder::IsRecording())
+	{
+		TraceRecorder::Stop();
+		TraceRecorder::Write(options.traceFile);
+	}
+}
+
+// Runs the simulation one tick per frame, as fast as it goes, with nothing to render
+void Game::RunHeadless()
+{
+	const int numFrames = options.numFrames > 0 ? options.numFrames : DEFAULT_HEADLESS_FRAMES;
+
+	const auto start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < numFrames && isRunning; frame++)
+	{
+		BeginFrame();
+		{
+			PROFILE_SCOPE("Game::Run");
+			Tick();
+		}
+		frameContext.frameNumber++;
+		EndFrame();
+	}
+	StopTrace();
+	const double elapsedMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	LogSystemTimings(elapsedMilliseconds);
+	if (!options.statsFile.empty())
+	{
+		CollectMemoryStats();
+		WriteStats(options.statsFile, elapsedMilliseconds);
+	}
+}
+
+void Game::LogSystemTimings(double elapsedMilliseconds) const
+{
+	const char* phaseNames[] = { "pre-update", "simulation", "post-update", "render" };
+
+	Logger::Log(std::to_string(frameContext.frameNumber) + " frames and " + std::to_string(frameContext.tickNumber) + " ticks in " +
+		std::to_string(elapsedMilliseconds) + " ms (" + std::to_string(elapsedMilliseconds > 0.0 ? frameContext.tickNumber * 1000.0 / elapsedMilliseconds : 0.0) + " ticks/s)");
+	for (int phase = 0; phase < NUM_SYSTEM_PHASES; phase++)
+	{
+		for (const System* system : registry->GetSystemsInPhase(static_cast<SystemPhase>(phase)))
+		{
+			Logger::Log(std::string("  [") + phaseNames[phase] + "] " + system->GetName() +
+				": average " + std::to_string(system->GetAverageRunMilliseconds()) + " ms, total " + std::to_string(system->GetTotalRunMilliseconds()) +
+				" ms, " + std::to_string(system->GetSystemEntities().size()) + " entities");
+		}
+	}
+
+	// Headless runs are not paced
+	const FramePacingStats& pacing = framePacer.GetStats();
+	if (pacing.numFrames > 0 && framePacer.GetTargetFps() > 0)
+	{
+		Logger::Log("Pacing at " + std::to_string(framePacer.GetTargetFps()) + " FPS: " + std::to_string(pacing.numMissedDeadlines) + " of " +
+			std::to_string(pacing.numFrames) + " deadlines missed, jitter average " + std::to_string(pacing.averageJitterMilliseconds) +
+			" ms, max " + std::to_string(pacing.maxJitterMilliseconds) + " ms");
+	}
+}
+
+bool Game::WriteStats(const std::string& path, double elapsedMilliseconds) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		Logger::Err("Cannot write stats to " + path);
+		return false;
+	}
+
+	const char* phaseNames[] = { "pre-update", "simulation", "post-update", "render" };
+
+	file << "{\n  \"storage\": \"" << (options.storageMode == StorageMode::Archetype ? "archetype" : "sparse") << "\",\n";
+	file << "  \"frames\": " << frameContext.frameNumber << ",\n  \"ticks\": " << frameContext.tickNumber << ",\n  \"elapsedMilliseconds\": " << elapsedMilliseconds << ",\n";
+	file << "  \"systems\": [";
+	bool isFirst = true;
+	for (int phase = 0; phase < NUM_SYSTEM_PHASES; phase++)
+	{
+		for (const System* system : registry->GetSystemsInPhase(static_cast<SystemPhase>(phase)))
+		{
+			file << (isFirst ? "\n" : ",\n") << "    {\"name\": \"" << system->GetName() << "\", \"phase\": \"" << phaseNames[phase] <<
+				"\", \"averageMilliseconds\": " << system->GetAverageRunMilliseconds() << ", \"totalMilliseconds\": " << system->GetTotalRunMilliseconds() <<
+				", \"entities\": " << system->GetSystemEntities().size() << "}";
+			isFirst = false;
+		}
+	}
+	file << "\n  ],\n";
+
+	const FramePacingStats& pacing = framePacer.GetStats();
+	file << "  \"pacing\": {\"targetFps\": " << framePacer.GetTargetFps() << ", \"frames\": " << pacing.numFrames << ", \"missedDeadlines\": " << pacing.numMissedDeadlines <<
+		", \"averageJitterMilliseconds\": " << pacing.averageJitterMilliseconds << ", \"maxJitterMilliseconds\": " << pacing.maxJitterMilliseconds <<
+		", \"waitMilliseconds\": " << pacing.totalWaitMilliseconds << ", \"jitterBucketMilliseconds\": " << PACING_BUCKET_MILLISECONDS << ", \"jitterHistogram\": [";
+	for (int bucket = 0; bucket < PACING_HISTOGRAM_BUCKETS; bucket++)
+	{
+		file << (bucket ? ", " : "") << pacing.jitterHistogram[bucket];
+	}
+	file << "]},\n";
+
+	file << "  \"memory\": {\n    \"usedBytes\": " << memoryReport.GetTotalUsedBytes() << ",\n    \"capacityBytes\": " << memoryReport.GetTotalCapacityBytes() <<
+		",\n    \"highWaterBytes\": " << memoryTracker.GetTotalHighWaterBytes() << ",\n    \"entries\": [";
+	isFirst = true;
+	for (const auto& entry : memoryReport.GetEntries())
+	{
+		file << (isFirst ? "\n" : ",\n") << "      {\"category\": \"" << entry.category << "\", \"name\": \"" << entry.name << "\", \"usedBytes\": " << entry.usedBytes <<
+			", \"capacityBytes\": " << entry.capacityBytes << ", \"highWaterBytes\": " << entry.highWaterBytes << "}";
+		isFirst = false;
+	}
+	file << "\n    ]\n  }\n}\n";
+
+	Logger::Log("Stats written to " + path);
+	return true;
 }
 
 void Game::Destroy()
 {
-	SDL_DestroyRenderer(renderer);
-	SDL_DestroyWindow(window);
+	if (renderer)
+	{
+		ImGuiSDL::Deinitialize();
+		ImGui::DestroyContext();
+		SDL_DestroyRenderer(renderer);
+	}
+	if (window)
+	{
+		SDL_DestroyWindow(window);
+	}
 	SDL_Quit();
 }
\ No newline at end of file
@@ -4,35 +4,163 @@
 #include <SDL.h>
 #include "../AssetStore/AssetStore.h"
 #include "../EventBus/EventBus.h"
+#include "FrameContext.h"
+#include "FramePacer.h"
+#include "../Physics/Broadphase.h"
+#include "../Physics/SpatialHash.h"
+#include "../Jobs/JobSystem.h"
+#include "../Profiler/ProfilerOverlay.h"
+#include "../Profiler/MemoryStats.h"
+#include "../Profiler/HitchLog.h"
+#include <chrono>
+#include <string>
 
 const int FPS = 60;
 const int MILLISECS_PER_FRAME = 1000 / FPS;
 
+// The simulation always advances by the same step, whatever the frame rate
+const int TICKS_PER_SECOND = 60;
+const double SECONDS_PER_TICK = 1.0 / TICKS_PER_SECOND;
+
+// Longest frame the simulation catches up on, a longer hitch (debugger, window drag) is dropped
+const double MAX_FRAME_SECONDS = 0.25;
+
+const int DEFAULT_FAST_FORWARD_TICKS = 8;
+
+enum class TimeMode
+{
+	// Ticks follow the wall clock, rendering is interpolated between the last two ticks
+	RealTime,
+	// A fixed number of ticks per rendered frame
+	FastForward,
+	// As many ticks as fit in a frame, to replay or soak-test faster than real time
+	Unthrottled
+};
+
+// Command line settings (see Main.cpp)
+struct GameOptions
+{
+	// Runs the simulation without window, renderer or textures, as fast as possible
+	bool isHeadless = false;
+
+	// Frames to run before quitting, 0 runs until the window is closed (headless runs a tick per frame)
+	int numFrames = 0;
+
+	// Built-in scene to load: "jungle" or "stress"
+	std::string scene = "jungle";
+
+	// Frame rate of the real time mode, 0 = uncapped (see FramePacer)
+	int targetFps = DEFAULT_TARGET_FPS;
+
+	// Lets the display pace the frames too, the frame rate is then capped to its refresh rate
+	bool isVsync = false;
+
+	// How the registry stores components, the same scenes can be measured on both
+	StorageMode storageMode = StorageMode::SparseSet;
+
+	// Moving entities spawned by the stress scene
+	int numStressEntities = 100000;
+
+	// Collision broadphase of the scene, and the grid cell of the spatial hash in pixels
+	BroadphaseType broadphase = BroadphaseType::SpatialHash;
+	float collisionCellSize = DEFAULT_COLLISION_CELL_SIZE;
+
+	// Chrome trace written for the frames from traceFirstFrame to traceLastFrame (-1 = until the game ends)
+	std::string traceFile;
+	int traceFirstFrame = 0;
+	int traceLastFrame = -1;
+
+	// JSON file written when the game ends with the system timings and the memory report
+	std::string statsFile;
+
+	// Binary log the frames over budget are appended to (empty = off), see HitchLog
+	// The budget is the frame period of targetFps, or MILLISECS_PER_FRAME when uncapped, headless runs never log
+	std::string hitchLogFile;
+};
+
+// Running totals read at the start of every frame, a slow frame reports how far they moved
+struct FrameCounters
+{
+	uint64_t tickNumber = 0;
+	uint64_t numEntitiesCreated = 0;
+	uint64_t numEntitiesKilled = 0;
+	uint64_t numEvents = 0;
+	uint64_t numAssetsLoaded = 0;
+};
+
+const int DEFAULT_HEADLESS_FRAMES = 600;
+
+// Frames between two memory samples while writing a stats file, often enough to catch the peaks of the pools and chunks
+const int MEMORY_STATS_SAMPLE_FRAMES = 10;
+
 class Game
 {
 	private:
 		bool isRunning;
 		bool isDebug;
-		int millisecsPreviousFrame = 0;
+		bool isProfilerVisible = false;
+		ProfilerOverlay profilerOverlay;
+
+		// Memory held by the engine, refreshed every frame while the overlay is visible
+		// and every MEMORY_STATS_SAMPLE_FRAMES frames for the stats file, the high-water marks cover those samples
+		MemoryReport memoryReport;
+		MemoryTracker memoryTracker;
+
+		// Frames over budget, with what happened during them
+		HitchLog hitchLog;
+		FrameCounters frameStartCounters;
+		// Time the frame spent sleeping until its start time, not counted against the budget
+		double frameWaitMilliseconds = 0.0;
+
+		GameOptions options;
+		FramePacer framePacer;
+
+		// Fixed timestep clock
+		TimeMode timeMode = TimeMode::RealTime;
+		int fastForwardTicks = DEFAULT_FAST_FORWARD_TICKS;
+		std::chrono::steady_clock::time_point previousFrameTime;
+		// Wall time not simulated yet, starts with a full tick so the first frame has something to show
+		double accumulator = SECONDS_PER_TICK;
 		SDL_Window* window;
 		SDL_Renderer* renderer;
 
+		// Declared before the registry so the workers outlive it
+		std::unique_ptr<JobSystem> jobSystem;
 		std::unique_ptr<Registry> registry;
 		std::unique_ptr<AssetStore> assetStore;
 		std::unique_ptr<EventBus> eventBus;
 
+		// Data shared with the systems, refreshed every frame
+		FrameContext frameContext;
+
 	public:
-		Game(); //constructor
+		Game(const GameOptions& options = GameOptions()); //constructor
 		~Game(); // destructor
 		void Initialize();
 		void Run();
 		void Setup();
 		void LoadLevel(int level);
+		void LoadStressScene(int numEntities);
+		void RunHeadless();
+		void LogSystemTimings(double elapsedMilliseconds) const;
+		void CollectMemoryStats();
+		bool WriteStats(const std::string& path, double elapsedMilliseconds) const;
 		void ProcessInput();
 		void Update();
+		void Tick();
+		void BeginFrame();
+		void EndFrame();
+		FrameCounters ReadFrameCounters() const;
+		void CheckFrameBudget();
+		void StartTrace();
+		void StopTrace();
 		void Render();
+		void RenderProfilerOverlay();
 		void Destroy();
 
+		// ticksPerFrame is only used by the fast-forward mode
+		void SetTimeMode(TimeMode mode, int ticksPerFrame = DEFAULT_FAST_FORWARD_TICKS);
+
 		int windowWidth;
 		int windowHeight;
 };
@@ -0,0 +1,161 @@
+#include "JobSystem.h"
+#include "../Profiler/TraceRecorder.h"
+#include <string>
+
+namespace
+{
+	// Which job system the current thread works for and the index of its queue
+	thread_local const JobSystem* currentJobSystem = nullptr;
+	thread_local int currentWorkerIndex = -1;
+}
+
+JobSystem::JobSystem(int numWorkers)
+{
+	if (numWorkers < 0)
+	{
+		numWorkers = 0;
+	}
+
+	for (int i = 0; i < numWorkers + 1; i++)
+	{
+		queues.push_back(std::make_unique<JobQueue>());
+	}
+
+	for (int i = 0; i < numWorkers; i++)
+	{
+		workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		isRunning = false;
+	}
+	wakeUp.notify_all();
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+int JobSystem::GetDefaultNumWorkers()
+{
+	const int numCores = static_cast<int>(std::thread::hardware_concurrency());
+	return numCores > 1 ? numCores - 1 : 0;
+}
+
+int JobSystem::GetQueueIndex() const
+{
+	if (currentJobSystem == this)
+	{
+		return currentWorkerIndex;
+	}
+	return static_cast<int>(workers.size());
+}
+
+void JobSystem::Submit(std::function<void()> function, JobCounter* counter)
+{
+	if (counter)
+	{
+		counter->pendingJobs.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	JobQueue& queue = *queues[GetQueueIndex()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back({ std::move(function), counter });
+	}
+
+	{
+		// Take the lock so a worker cannot miss the job between checking the count and going to sleep
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		numQueuedJobs++;
+	}
+	wakeUp.notify_one();
+}
+
+bool JobSystem::TakeJob(int queueIndex, Job& job)
+{
+	// The newest job of our own queue is the most likely to still be in cache
+	{
+		JobQueue& queue = *queues[queueIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.jobs.empty())
+		{
+			job = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+			numQueuedJobs--;
+			return true;
+		}
+	}
+
+	// Otherwise steal the oldest job of another queue
+	const int numQueues = static_cast<int>(queues.size());
+	for (int offset = 1; offset < numQueues; offset++)
+	{
+		JobQueue& queue = *queues[(queueIndex + offset) % numQueues];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.jobs.empty())
+		{
+			job = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+			numQueuedJobs--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::RunJob(Job& job)
+{
+	job.function();
+	if (job.counter)
+	{
+		job.counter->pendingJobs.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+void JobSystem::WorkerLoop(int workerIndex)
+{
+	currentJobSystem = this;
+	currentWorkerIndex = workerIndex;
+	TraceRecorder::SetThreadName("Worker " + std::to_string(workerIndex + 1));
+
+	while (true)
+	{
+		Job job;
+		if (TakeJob(workerIndex, job))
+		{
+			RunJob(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wakeUp.wait(lock, [this]() { return !isRunning || numQueuedJobs > 0; });
+		if (!isRunning)
+		{
+			return;
+		}
+	}
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	const int queueIndex = GetQueueIndex();
+	while (!counter.IsDone())
+	{
+		Job job;
+		if (TakeJob(queueIndex, job))
+		{
+			RunJob(job);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
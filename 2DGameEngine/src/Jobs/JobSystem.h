@@ -0,0 +1,124 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts the jobs of a group that are still queued or running
+class JobCounter
+{
+private:
+	std::atomic<int> pendingJobs{ 0 };
+
+public:
+	bool IsDone() const { return pendingJobs.load(std::memory_order_acquire) == 0; }
+
+	friend class JobSystem;
+};
+
+/////////////////////////
+// JOB SYSTEM
+// A pool of worker threads, each with its own queue of jobs
+// A worker takes the newest job of its own queue and steals the oldest job of another queue when it runs dry
+// Threads that are not workers (the main thread) share one extra queue and help run jobs while they wait
+/////////////////////////
+class JobSystem
+{
+private:
+	struct Job
+	{
+		std::function<void()> function;
+		JobCounter* counter;
+	};
+
+	struct JobQueue
+	{
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	// [index = worker index], the last queue belongs to the threads that are not workers
+	std::vector<std::unique_ptr<JobQueue>> queues;
+	std::vector<std::thread> workers;
+
+	std::atomic<bool> isRunning{ true };
+	std::atomic<int> numQueuedJobs{ 0 };
+	std::mutex sleepMutex;
+	std::condition_variable wakeUp;
+
+	int GetQueueIndex() const;
+	bool TakeJob(int queueIndex, Job& job);
+	void RunJob(Job& job);
+	void WorkerLoop(int workerIndex);
+
+public:
+	// With no worker every job runs on the thread that waits for it
+	explicit JobSystem(int numWorkers);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// Number of threads running jobs, the waiting thread included
+	int GetNumThreads() const { return static_cast<int>(workers.size()) + 1; }
+
+	// Queues a job, jobs can submit more jobs to the same counter while it is waited on
+	void Submit(std::function<void()> function, JobCounter* counter = nullptr);
+
+	// Runs queued jobs until every job of the counter is finished
+	void Wait(JobCounter& counter);
+
+	// Splits [0, count) into ranges of rangeSize items and calls func(begin, end) once per range
+	// Ranges are handed out to at most maxThreads threads (0 = all), the calling thread included,
+	// each thread taking the next range as soon as it is done so uneven ranges balance themselves
+	template <typename TFunc>
+	void ParallelFor(size_t count, size_t rangeSize, TFunc func, int maxThreads = 0);
+
+	// Default worker count: one thread per core, the main thread being one of them
+	static int GetDefaultNumWorkers();
+};
+
+template <typename TFunc>
+void JobSystem::ParallelFor(size_t count, size_t rangeSize, TFunc func, int maxThreads)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	rangeSize = std::max<size_t>(rangeSize, 1);
+
+	const size_t numRanges = (count + rangeSize - 1) / rangeSize;
+	int numThreads = GetNumThreads();
+	if (maxThreads > 0)
+	{
+		numThreads = std::min(numThreads, maxThreads);
+	}
+	numThreads = static_cast<int>(std::min<size_t>(numThreads, numRanges));
+
+	std::atomic<size_t> nextRange{ 0 };
+	auto work = [&]()
+	{
+		for (size_t range = nextRange.fetch_add(1); range < numRanges; range = nextRange.fetch_add(1))
+		{
+			const size_t begin = range * rangeSize;
+			func(begin, std::min(begin + rangeSize, count));
+		}
+	};
+
+	JobCounter counter;
+	for (int i = 1; i < numThreads; i++)
+	{
+		Submit(work, &counter);
+	}
+	work();
+	Wait(counter);
+}
+
+#endif
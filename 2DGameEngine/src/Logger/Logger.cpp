@@ -3,8 +3,14 @@
 #include <iostream>
 #include <chrono>
 #include <ctime>
+#include <mutex>
 
 std::vector<LogEntry> Logger::messages;
+size_t Logger::messageBytes = 0;
+bool Logger::isInfoEnabled = true;
+
+// Systems can log from worker threads
+static std::mutex logMutex;
 
 std::string CurrentDateTimeToString()
 {
@@ -16,19 +22,37 @@ std::string CurrentDateTimeToString()
 
 void Logger::Log(const std::string& message)
 {
+	if (!isInfoEnabled)
+	{
+		return;
+	}
+
 	LogEntry logEntry;
 	logEntry.type = LOG_INFO;
 	logEntry.message = "LOG: [" + CurrentDateTimeToString() + "]: " + message;
+
+	std::lock_guard<std::mutex> lock(logMutex);
 	std::cout << "\x1B[32m" << logEntry.message << "\033[0m" << std::endl;
 
+	messageBytes += logEntry.message.size();
 	messages.push_back(logEntry);
 }
 
+void Logger::GetMemoryUse(size_t& usedBytes, size_t& capacityBytes)
+{
+	std::lock_guard<std::mutex> lock(logMutex);
+	usedBytes = messages.size() * sizeof(LogEntry) + messageBytes;
+	capacityBytes = messages.capacity() * sizeof(LogEntry) + messageBytes;
+}
+
 void Logger::Err(const std::string& message)
 {
 	LogEntry logEntry;
 	logEntry.type = LOG_ERROR;
 	logEntry.message = "ERR: [" + CurrentDateTimeToString() + "]: " + message;
+
+	std::lock_guard<std::mutex> lock(logMutex);
 	std::cerr << "\x1B[91m" << logEntry.message << "\033[0m" << std::endl;
+	messageBytes += logEntry.message.size();
 	messages.push_back(logEntry);
 }
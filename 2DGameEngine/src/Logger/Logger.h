@@ -21,8 +21,14 @@ class Logger
 {
 	public:
 		static std::vector<LogEntry> messages;
+		// Characters held by the messages, kept as they are added so the log size is known without walking it
+		static size_t messageBytes;
+		// Turns Log() off, errors are always reported
+		static bool isInfoEnabled;
 		static void Log(const std::string& message);
 		static void Err(const std::string& message);
+		// Bytes held by the messages, read under the log lock since workers may be logging
+		static void GetMemoryUse(size_t& usedBytes, size_t& capacityBytes);
 };
 
 #endif
\ No newline at end of file
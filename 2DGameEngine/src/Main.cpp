@@ -1,13 +1,178 @@
 #include <iostream>
+#include <string>
+#include <cstdlib>
+#include <sstream>
 #include "./Game/Game.h"
+#include "./Benchmark/Benchmark.h"
+
+const char* USAGE =
+    " [--headless] [--frames N] [--scene jungle|stress] [--entities N] [--storage sparse|archetype]\n"
+    "    [--fps N|uncapped] [--vsync] [--broadphase hash|sap|tree] [--collision-cell PIXELS]\n"
+    "    [--trace FILE.json [--trace-frames FIRST:LAST]] [--stats FILE.json]\n"
+    "    [--hitch-log FILE] [--hitch-report FILE]\n"
+    "    [--bench [--bench-sizes N,N,...] [--bench-filter TEXT] [--bench-output FILE.csv|FILE.json]\n"
+    "             [--bench-baseline FILE.csv] [--bench-threshold PERCENT]]";
+
+// "1000,100000" -> { 1000, 100000 }
+std::vector<int> ParseSizes(const std::string& text)
+{
+    std::vector<int> sizes;
+    std::stringstream stream(text);
+    std::string size;
+    while (std::getline(stream, size, ','))
+    {
+        sizes.push_back(std::atoi(size.c_str()));
+    }
+    return sizes;
+}
+
+bool ParseArguments(int argc, char* argv[], GameOptions& options, bool& isBenchmark, BenchmarkOptions& benchmarkOptions, std::string& hitchReportFile)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (argument == "--headless")
+        {
+            options.isHeadless = true;
+        }
+        else if (argument == "--frames" && hasValue)
+        {
+            options.numFrames = std::atoi(argv[++i]);
+        }
+        else if (argument == "--scene" && hasValue)
+        {
+            options.scene = argv[++i];
+        }
+        else if (argument == "--entities" && hasValue)
+        {
+            options.numStressEntities = std::atoi(argv[++i]);
+        }
+        else if (argument == "--storage" && hasValue)
+        {
+            const std::string storage = argv[++i];
+            if (storage == "sparse")
+            {
+                options.storageMode = StorageMode::SparseSet;
+            }
+            else if (storage == "archetype")
+            {
+                options.storageMode = StorageMode::Archetype;
+            }
+            else
+            {
+                std::cerr << "Unknown storage " << storage << ", expected sparse or archetype" << std::endl;
+                return false;
+            }
+        }
+        else if (argument == "--broadphase" && hasValue)
+        {
+            if (!ParseBroadphaseType(argv[++i], options.broadphase))
+            {
+                std::cerr << "Unknown broadphase " << argv[i] << ", expected hash, sap or tree" << std::endl;
+                return false;
+            }
+        }
+        else if (argument == "--collision-cell" && hasValue)
+        {
+            options.collisionCellSize = static_cast<float>(std::atof(argv[++i]));
+        }
+        else if (argument == "--fps" && hasValue)
+        {
+            const std::string rate = argv[++i];
+            options.targetFps = rate == "uncapped" ? 0 : std::atoi(rate.c_str());
+        }
+        else if (argument == "--vsync")
+        {
+            options.isVsync = true;
+        }
+        else if (argument == "--trace" && hasValue)
+        {
+            options.traceFile = argv[++i];
+        }
+        else if (argument == "--trace-frames" && hasValue)
+        {
+            // "FIRST:LAST", or "FIRST" to trace until the game ends
+            const std::string range = argv[++i];
+            const size_t separator = range.find(':');
+            options.traceFirstFrame = std::atoi(range.substr(0, separator).c_str());
+            options.traceLastFrame = separator == std::string::npos ? -1 : std::atoi(range.substr(separator + 1).c_str());
+        }
+        else if (argument == "--stats" && hasValue)
+        {
+            options.statsFile = argv[++i];
+        }
+        else if (argument == "--hitch-log" && hasValue)
+        {
+            options.hitchLogFile = argv[++i];
+        }
+        else if (argument == "--hitch-report" && hasValue)
+        {
+            hitchReportFile = argv[++i];
+        }
+        else if (argument == "--bench")
+        {
+            isBenchmark = true;
+        }
+        else if (argument == "--bench-sizes" && hasValue)
+        {
+            benchmarkOptions.sizes = ParseSizes(argv[++i]);
+        }
+        else if (argument == "--bench-filter" && hasValue)
+        {
+            benchmarkOptions.filter = argv[++i];
+        }
+        else if (argument == "--bench-output" && hasValue)
+        {
+            benchmarkOptions.outputPath = argv[++i];
+        }
+        else if (argument == "--bench-baseline" && hasValue)
+        {
+            benchmarkOptions.baselinePath = argv[++i];
+        }
+        else if (argument == "--bench-threshold" && hasValue)
+        {
+            benchmarkOptions.regressionThreshold = std::atof(argv[++i]) / 100.0;
+        }
+        else
+        {
+            std::cerr << "Unknown argument " << argument << std::endl;
+            std::cerr << "Usage: " << argv[0] << USAGE << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
 
 int main(int argc, char* argv[]) {
     
-    Game game;
+    GameOptions options;
+    bool isBenchmark = false;
+    BenchmarkOptions benchmarkOptions;
+    std::string hitchReportFile;
+    if (!ParseArguments(argc, argv, options, isBenchmark, benchmarkOptions, hitchReportFile))
+    {
+        return 1;
+    }
+
+    // Summarizes the slow frames of an earlier session, nothing is run
+    if (!hitchReportFile.empty())
+    {
+        return PrintHitchReport(hitchReportFile) ? 0 : 1;
+    }
+
+    // The benchmarks only need the engine code, no window is opened
+    if (isBenchmark)
+    {
+        return RunBenchmarks(benchmarkOptions);
+    }
+
+    Game game(options);
 
     game.Initialize();
     game.Run(); //game loop
     game.Destroy();
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,45 @@
+#ifndef AABB_H
+#define AABB_H
+
+// Axis-aligned box in world pixels, from its top-left (min) to its bottom-right (max) corner
+struct AABB
+{
+	float minX;
+	float minY;
+	float maxX;
+	float maxY;
+
+	AABB(float minX = 0.0f, float minY = 0.0f, float maxX = 0.0f, float maxY = 0.0f) : minX(minX), minY(minY), maxX(maxX), maxY(maxY) {}
+
+	float GetWidth() const { return maxX - minX; }
+	float GetHeight() const { return maxY - minY; }
+
+	// Boxes that only touch do not overlap, like the narrowphase kernels (see OverlapKernel.h)
+	bool Overlaps(const AABB& other) const
+	{
+		return minX < other.maxX && maxX > other.minX && minY < other.maxY && maxY > other.minY;
+	}
+
+	bool Contains(const AABB& other) const
+	{
+		return minX <= other.minX && minY <= other.minY && maxX >= other.maxX && maxY >= other.maxY;
+	}
+
+	bool Contains(float x, float y) const
+	{
+		return minX <= x && x <= maxX && minY <= y && y <= maxY;
+	}
+
+	float GetPerimeter() const { return 2.0f * (GetWidth() + GetHeight()); }
+
+	// Box grown by margin on every side
+	AABB Expanded(float margin) const { return AABB(minX - margin, minY - margin, maxX + margin, maxY + margin); }
+
+	// Smallest box holding both
+	static AABB Union(const AABB& a, const AABB& b)
+	{
+		return AABB(a.minX < b.minX ? a.minX : b.minX, a.minY < b.minY ? a.minY : b.minY, a.maxX > b.maxX ? a.maxX : b.maxX, a.maxY > b.maxY ? a.maxY : b.maxY);
+	}
+};
+
+#endif
@@ -0,0 +1,368 @@
+#include "AABBTree.h"
+#include <algorithm>
+
+int DynamicAABBTree::AllocateNode()
+{
+	int node;
+	if (freeList == AABB_TREE_NULL_NODE)
+	{
+		node = static_cast<int>(nodes.size());
+		nodes.emplace_back();
+	}
+	else
+	{
+		node = freeList;
+		freeList = nodes[node].parent;
+		nodes[node] = Node();
+	}
+	return node;
+}
+
+void DynamicAABBTree::FreeNode(int node)
+{
+	nodes[node].parent = freeList;
+	nodes[node].height = -1;
+	freeList = node;
+}
+
+int DynamicAABBTree::CreateProxy(const AABB& box, int userData)
+{
+	const int proxy = AllocateNode();
+	nodes[proxy].box = box;
+	nodes[proxy].fatBox = box.Expanded(AABB_TREE_MARGIN);
+	nodes[proxy].userData = userData;
+	InsertLeaf(proxy);
+	numProxies++;
+	return proxy;
+}
+
+void DynamicAABBTree::DestroyProxy(int proxy)
+{
+	RemoveLeaf(proxy);
+	FreeNode(proxy);
+	numProxies--;
+}
+
+bool DynamicAABBTree::MoveProxy(int proxy, const AABB& box)
+{
+	Node& node = nodes[proxy];
+	const float dx = AABB_TREE_DISPLACEMENT_MULTIPLIER * (box.minX - node.box.minX);
+	const float dy = AABB_TREE_DISPLACEMENT_MULTIPLIER * (box.minY - node.box.minY);
+	node.box = box;
+
+	// Stretch the new fattened box ahead of the collider, where it is heading
+	AABB fatBox = box.Expanded(AABB_TREE_MARGIN);
+	(dx < 0.0f ? fatBox.minX : fatBox.maxX) += dx;
+	(dy < 0.0f ? fatBox.minY : fatBox.maxY) += dy;
+
+	// Still inside its fattened box, unless that box grew much larger than needed after a fast move
+	if (node.fatBox.Contains(box) && fatBox.Expanded(4.0f * AABB_TREE_MARGIN).Contains(node.fatBox))
+	{
+		return false;
+	}
+
+	RemoveLeaf(proxy);
+	nodes[proxy].fatBox = fatBox;
+	InsertLeaf(proxy);
+	return true;
+}
+
+void DynamicAABBTree::InsertLeaf(int leaf)
+{
+	if (root == AABB_TREE_NULL_NODE)
+	{
+		root = leaf;
+		nodes[root].parent = AABB_TREE_NULL_NODE;
+		return;
+	}
+
+	// Find the best sibling: descend while a child costs less than pairing the leaf with the current node
+	const AABB leafBox = nodes[leaf].fatBox;
+	int index = root;
+	while (!nodes[index].IsLeaf())
+	{
+		const Node& node = nodes[index];
+		const float perimeter = node.fatBox.GetPerimeter();
+		const float combinedPerimeter = AABB::Union(node.fatBox, leafBox).GetPerimeter();
+
+		// Cost of a new parent for this node and the leaf
+		const float cost = 2.0f * combinedPerimeter;
+		// Every ancestor of the leaf grows by this much whichever child it goes down
+		const float inheritanceCost = 2.0f * (combinedPerimeter - perimeter);
+
+		float childCosts[2];
+		const int children[2] = { node.child1, node.child2 };
+		for (int i = 0; i < 2; i++)
+		{
+			const Node& child = nodes[children[i]];
+			const float grownPerimeter = AABB::Union(leafBox, child.fatBox).GetPerimeter();
+			childCosts[i] = (child.IsLeaf() ? grownPerimeter : grownPerimeter - child.fatBox.GetPerimeter()) + inheritanceCost;
+		}
+
+		if (cost < childCosts[0] && cost < childCosts[1])
+		{
+			break;
+		}
+		index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+	}
+	const int sibling = index;
+
+	// Allocating may move the nodes, no reference is held across it
+	const int oldParent = nodes[sibling].parent;
+	const int newParent = AllocateNode();
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].fatBox = AABB::Union(leafBox, nodes[sibling].fatBox);
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].child1 = sibling;
+	nodes[newParent].child2 = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if (oldParent == AABB_TREE_NULL_NODE)
+	{
+		root = newParent;
+	}
+	else if (nodes[oldParent].child1 == sibling)
+	{
+		nodes[oldParent].child1 = newParent;
+	}
+	else
+	{
+		nodes[oldParent].child2 = newParent;
+	}
+
+	Refit(nodes[leaf].parent);
+}
+
+void DynamicAABBTree::RemoveLeaf(int leaf)
+{
+	if (leaf == root)
+	{
+		root = AABB_TREE_NULL_NODE;
+		return;
+	}
+
+	// The sibling takes the place of the parent
+	const int parent = nodes[leaf].parent;
+	const int grandParent = nodes[parent].parent;
+	const int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+	if (grandParent == AABB_TREE_NULL_NODE)
+	{
+		root = sibling;
+		nodes[sibling].parent = AABB_TREE_NULL_NODE;
+		FreeNode(parent);
+		return;
+	}
+
+	if (nodes[grandParent].child1 == parent)
+	{
+		nodes[grandParent].child1 = sibling;
+	}
+	else
+	{
+		nodes[grandParent].child2 = sibling;
+	}
+	nodes[sibling].parent = grandParent;
+	FreeNode(parent);
+
+	Refit(grandParent);
+}
+
+void DynamicAABBTree::Refit(int index)
+{
+	while (index != AABB_TREE_NULL_NODE)
+	{
+		index = Balance(index);
+
+		Node& node = nodes[index];
+		const Node& child1 = nodes[node.child1];
+		const Node& child2 = nodes[node.child2];
+		node.height = 1 + std::max(child1.height, child2.height);
+		node.fatBox = AABB::Union(child1.fatBox, child2.fatBox);
+
+		index = node.parent;
+	}
+}
+
+int DynamicAABBTree::Balance(int iA)
+{
+	Node& a = nodes[iA];
+	if (a.IsLeaf() || a.height < 2)
+	{
+		return iA;
+	}
+
+	const int iB = a.child1;
+	const int iC = a.child2;
+	Node& b = nodes[iB];
+	Node& c = nodes[iC];
+	const int balance = c.height - b.height;
+
+	// Rotate C up, A becomes its child and takes the shorter of C's children
+	if (balance > 1)
+	{
+		const int iF = c.child1;
+		const int iG = c.child2;
+		Node& f = nodes[iF];
+		Node& g = nodes[iG];
+
+		c.child1 = iA;
+		c.parent = a.parent;
+		a.parent = iC;
+		if (c.parent == AABB_TREE_NULL_NODE)
+		{
+			root = iC;
+		}
+		else if (nodes[c.parent].child1 == iA)
+		{
+			nodes[c.parent].child1 = iC;
+		}
+		else
+		{
+			nodes[c.parent].child2 = iC;
+		}
+
+		if (f.height > g.height)
+		{
+			c.child2 = iF;
+			a.child2 = iG;
+			g.parent = iA;
+			a.fatBox = AABB::Union(b.fatBox, g.fatBox);
+			c.fatBox = AABB::Union(a.fatBox, f.fatBox);
+			a.height = 1 + std::max(b.height, g.height);
+			c.height = 1 + std::max(a.height, f.height);
+		}
+		else
+		{
+			c.child2 = iG;
+			a.child2 = iF;
+			f.parent = iA;
+			a.fatBox = AABB::Union(b.fatBox, f.fatBox);
+			c.fatBox = AABB::Union(a.fatBox, g.fatBox);
+			a.height = 1 + std::max(b.height, f.height);
+			c.height = 1 + std::max(a.height, g.height);
+		}
+		return iC;
+	}
+
+	// Rotate B up, the mirror image
+	if (balance < -1)
+	{
+		const int iD = b.child1;
+		const int iE = b.child2;
+		Node& d = nodes[iD];
+		Node& e = nodes[iE];
+
+		b.child1 = iA;
+		b.parent = a.parent;
+		a.parent = iB;
+		if (b.parent == AABB_TREE_NULL_NODE)
+		{
+			root = iB;
+		}
+		else if (nodes[b.parent].child1 == iA)
+		{
+			nodes[b.parent].child1 = iB;
+		}
+		else
+		{
+			nodes[b.parent].child2 = iB;
+		}
+
+		if (d.height > e.height)
+		{
+			b.child2 = iD;
+			a.child1 = iE;
+			e.parent = iA;
+			a.fatBox = AABB::Union(c.fatBox, e.fatBox);
+			b.fatBox = AABB::Union(a.fatBox, d.fatBox);
+			a.height = 1 + std::max(c.height, e.height);
+			b.height = 1 + std::max(a.height, d.height);
+		}
+		else
+		{
+			b.child2 = iE;
+			a.child1 = iD;
+			d.parent = iA;
+			a.fatBox = AABB::Union(c.fatBox, d.fatBox);
+			b.fatBox = AABB::Union(a.fatBox, e.fatBox);
+			a.height = 1 + std::max(c.height, d.height);
+			b.height = 1 + std::max(a.height, e.height);
+		}
+		return iB;
+	}
+
+	return iA;
+}
+
+bool IntersectRay(const AABB& box, glm::vec2 origin, glm::vec2 direction, float maxDistance, float& distance)
+{
+	// Slab test: the ray is inside the box where it is between both pairs of sides at once
+	float enterDistance = 0.0f;
+	float exitDistance = maxDistance;
+	const float minimums[2] = { box.minX, box.minY };
+	const float maximums[2] = { box.maxX, box.maxY };
+	for (int axis = 0; axis < 2; axis++)
+	{
+		if (direction[axis] == 0.0f)
+		{
+			// Parallel to these sides, the ray is between them everywhere or nowhere
+			if (origin[axis] < minimums[axis] || origin[axis] > maximums[axis])
+			{
+				return false;
+			}
+			continue;
+		}
+
+		const float inverse = 1.0f / direction[axis];
+		float nearDistance = (minimums[axis] - origin[axis]) * inverse;
+		float farDistance = (maximums[axis] - origin[axis]) * inverse;
+		if (nearDistance > farDistance)
+		{
+			std::swap(nearDistance, farDistance);
+		}
+		enterDistance = std::max(enterDistance, nearDistance);
+		exitDistance = std::min(exitDistance, farDistance);
+		if (enterDistance > exitDistance)
+		{
+			return false;
+		}
+	}
+	distance = enterDistance;
+	return true;
+}
+
+void AABBTreeBroadphase::Update(const std::vector<AABB>& bounds)
+{
+	const size_t numKept = std::min(bounds.size(), proxies.size());
+	for (size_t i = 0; i < numKept; i++)
+	{
+		tree.MoveProxy(proxies[i], bounds[i]);
+	}
+	for (size_t i = bounds.size(); i < proxies.size(); i++)
+	{
+		tree.DestroyProxy(proxies[i]);
+	}
+	proxies.resize(numKept);
+	for (size_t i = numKept; i < bounds.size(); i++)
+	{
+		proxies.push_back(tree.CreateProxy(bounds[i], static_cast<int>(i)));
+	}
+}
+
+void AABBTreeBroadphase::FindPairs(std::vector<std::pair<int, int>>& pairs) const
+{
+	for (int i = 0; i < static_cast<int>(proxies.size()); i++)
+	{
+		// Each pair is found from both of its boxes, only the lower index reports it
+		tree.QueryAABB(tree.GetBox(proxies[i]), [&pairs, i](int other)
+		{
+			if (other > i)
+			{
+				pairs.emplace_back(i, other);
+			}
+			return true;
+		});
+	}
+}
@@ -0,0 +1,265 @@
+#ifndef AABBTREE_H
+#define AABBTREE_H
+
+#include "Broadphase.h"
+#include <glm/glm.hpp>
+#include <limits>
+#include <vector>
+
+const int AABB_TREE_NULL_NODE = -1;
+
+// Leaves hold their box grown by this margin, so a collider moving less than it does not touch the tree
+const float AABB_TREE_MARGIN = 4.0f;
+
+// The fattened box also stretches ahead of the collider by this many times its last displacement
+const float AABB_TREE_DISPLACEMENT_MULTIPLIER = 2.0f;
+
+// Depth of tree the queries traverse without allocating, a balanced tree reaches it past billions of leaves
+const int AABB_TREE_STACK_CAPACITY = 64;
+
+// Nodes left to visit by a tree query, kept on the call stack so a query does not allocate
+// Only a tree deeper than AABB_TREE_STACK_CAPACITY, which balancing prevents, falls back to the heap
+class AABBTreeStack
+{
+private:
+	int localNodes[AABB_TREE_STACK_CAPACITY];
+	std::vector<int> heapNodes;
+	int* nodes;
+	int size = 0;
+
+public:
+	// A depth-first walk that pushes both children holds at most height + 1 nodes
+	explicit AABBTreeStack(int height)
+	{
+		nodes = localNodes;
+		if (height + 1 > AABB_TREE_STACK_CAPACITY)
+		{
+			heapNodes.resize(height + 1);
+			nodes = heapNodes.data();
+		}
+	}
+
+	AABBTreeStack(const AABBTreeStack&) = delete;
+	AABBTreeStack& operator=(const AABBTreeStack&) = delete;
+
+	bool IsEmpty() const { return size == 0; }
+	void Push(int node) { nodes[size++] = node; }
+	int Pop() { return nodes[--size]; }
+};
+
+// Closest box a ray hit, userData is AABB_TREE_NULL_NODE when it hit nothing
+struct RaycastHit
+{
+	int userData = AABB_TREE_NULL_NODE;
+	float distance = 0.0f;
+	glm::vec2 point = glm::vec2(0.0f);
+
+	bool HasHit() const { return userData != AABB_TREE_NULL_NODE; }
+};
+
+// Distance along the ray at which it enters the box, if it does before maxDistance
+// direction must be normalized for the distance to be in pixels
+bool IntersectRay(const AABB& box, glm::vec2 origin, glm::vec2 direction, float maxDistance, float& distance);
+
+/////////////////////////
+// DYNAMIC AABB TREE
+// Bounding volume hierarchy of fattened boxes, every leaf is a proxy for one collider
+// A new leaf goes down the branch that grows the tree's perimeter the least, and the nodes on its way
+// back to the root are rotated when one child gets more than one level taller than the other
+// Moving a proxy only reinserts it once its box leaves the fattened box
+// Example: int proxy = tree.CreateProxy(box, entityId); tree.MoveProxy(proxy, newBox);
+//          tree.QueryAABB(area, [](int entityId) { ...; return true; });
+/////////////////////////
+class DynamicAABBTree
+{
+private:
+	struct Node
+	{
+		// Box of the collider, only set on leaves
+		AABB box;
+		// Fattened box on leaves, union of the children's fattened boxes on internal nodes
+		AABB fatBox;
+		// Parent node, or next free node while the node is in the free list
+		int parent = AABB_TREE_NULL_NODE;
+		int child1 = AABB_TREE_NULL_NODE;
+		int child2 = AABB_TREE_NULL_NODE;
+		// 0 for leaves, -1 for free nodes
+		int height = 0;
+		int userData = AABB_TREE_NULL_NODE;
+
+		bool IsLeaf() const { return child1 == AABB_TREE_NULL_NODE; }
+	};
+
+	std::vector<Node> nodes;
+	int root = AABB_TREE_NULL_NODE;
+	int freeList = AABB_TREE_NULL_NODE;
+	int numProxies = 0;
+
+	int AllocateNode();
+	void FreeNode(int node);
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	// Rotates the taller grandchild up if the node is unbalanced, returns the node now at its place
+	int Balance(int node);
+	// Refreshes the height and box of the nodes from node up to the root, balancing them on the way
+	void Refit(int node);
+
+public:
+	// userData is handed back by the queries, the collider's index or entity id
+	int CreateProxy(const AABB& box, int userData);
+	void DestroyProxy(int proxy);
+	// Returns true when the proxy had to be reinserted
+	bool MoveProxy(int proxy, const AABB& box);
+
+	const AABB& GetBox(int proxy) const { return nodes[proxy].box; }
+	int GetUserData(int proxy) const { return nodes[proxy].userData; }
+	int GetNumProxies() const { return numProxies; }
+	// 0 when empty or with a single proxy
+	int GetHeight() const { return root == AABB_TREE_NULL_NODE ? 0 : nodes[root].height; }
+
+	// Calls callback(userData) for every box overlapping area, until the callback returns false
+	template <typename TCallback>
+	void QueryAABB(const AABB& area, TCallback callback) const;
+
+	// Calls callback(userData) for every box holding the point, edges included, until the callback returns false
+	template <typename TCallback>
+	void QueryPoint(glm::vec2 point, TCallback callback) const;
+
+	// Closest box along the ray, direction does not need to be normalized
+	// filter(userData) returns false for the boxes the ray goes through, such as the shooter's own
+	template <typename TFilter>
+	RaycastHit Raycast(glm::vec2 origin, glm::vec2 direction, float maxDistance, TFilter filter) const;
+	RaycastHit Raycast(glm::vec2 origin, glm::vec2 direction, float maxDistance) const
+	{
+		return Raycast(origin, direction, maxDistance, [](int) { return true; });
+	}
+};
+
+template <typename TCallback>
+void DynamicAABBTree::QueryAABB(const AABB& area, TCallback callback) const
+{
+	if (root == AABB_TREE_NULL_NODE)
+	{
+		return;
+	}
+
+	AABBTreeStack stack(GetHeight());
+	stack.Push(root);
+	while (!stack.IsEmpty())
+	{
+		const Node& node = nodes[stack.Pop()];
+		if (!node.fatBox.Overlaps(area))
+		{
+			continue;
+		}
+		if (node.IsLeaf())
+		{
+			if (node.box.Overlaps(area) && !callback(node.userData))
+			{
+				return;
+			}
+		}
+		else
+		{
+			stack.Push(node.child1);
+			stack.Push(node.child2);
+		}
+	}
+}
+
+template <typename TCallback>
+void DynamicAABBTree::QueryPoint(glm::vec2 point, TCallback callback) const
+{
+	if (root == AABB_TREE_NULL_NODE)
+	{
+		return;
+	}
+
+	AABBTreeStack stack(GetHeight());
+	stack.Push(root);
+	while (!stack.IsEmpty())
+	{
+		const Node& node = nodes[stack.Pop()];
+		if (!node.fatBox.Contains(point.x, point.y))
+		{
+			continue;
+		}
+		if (node.IsLeaf())
+		{
+			if (node.box.Contains(point.x, point.y) && !callback(node.userData))
+			{
+				return;
+			}
+		}
+		else
+		{
+			stack.Push(node.child1);
+			stack.Push(node.child2);
+		}
+	}
+}
+
+template <typename TFilter>
+RaycastHit DynamicAABBTree::Raycast(glm::vec2 origin, glm::vec2 direction, float maxDistance, TFilter filter) const
+{
+	RaycastHit hit;
+	const float length = glm::length(direction);
+	if (root == AABB_TREE_NULL_NODE || length == 0.0f)
+	{
+		return hit;
+	}
+	direction /= length;
+
+	// The closest hit so far shortens the ray, the subtrees it cannot reach any more are skipped
+	float closestDistance = maxDistance;
+	AABBTreeStack stack(GetHeight());
+	stack.Push(root);
+	while (!stack.IsEmpty())
+	{
+		const Node& node = nodes[stack.Pop()];
+		float distance;
+		if (!IntersectRay(node.fatBox, origin, direction, closestDistance, distance))
+		{
+			continue;
+		}
+		if (node.IsLeaf())
+		{
+			if (IntersectRay(node.box, origin, direction, closestDistance, distance) && filter(node.userData))
+			{
+				closestDistance = distance;
+				hit.userData = node.userData;
+				hit.distance = distance;
+				hit.point = origin + direction * distance;
+			}
+		}
+		else
+		{
+			stack.Push(node.child1);
+			stack.Push(node.child2);
+		}
+	}
+	return hit;
+}
+
+/////////////////////////
+// AABB TREE BROADPHASE
+// Keeps one proxy per collider index, moved every tick, and pairs every collider with the boxes its query finds
+// The tree stays useful between ticks for scene queries (see CollisionSystem::Raycast())
+/////////////////////////
+class AABBTreeBroadphase : public IBroadphase
+{
+private:
+	DynamicAABBTree tree;
+	// [index = collider] proxy in the tree, the user data of a proxy is its collider index
+	std::vector<int> proxies;
+
+public:
+	const char* GetName() const override { return "aabb tree"; }
+
+	void Update(const std::vector<AABB>& bounds) override;
+	void FindPairs(std::vector<std::pair<int, int>>& pairs) const override;
+
+	const DynamicAABBTree& GetTree() const { return tree; }
+};
+
+#endif
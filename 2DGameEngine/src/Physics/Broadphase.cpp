@@ -0,0 +1,39 @@
+#include "Broadphase.h"
+#include "SpatialHash.h"
+#include "SweepAndPrune.h"
+#include "AABBTree.h"
+
+std::unique_ptr<IBroadphase> CreateBroadphase(BroadphaseType type, float cellSize)
+{
+	switch (type)
+	{
+		case BroadphaseType::SweepAndPrune:
+			return std::make_unique<SweepAndPrune>();
+		case BroadphaseType::AABBTree:
+			return std::make_unique<AABBTreeBroadphase>();
+		case BroadphaseType::SpatialHash:
+		default:
+			return std::make_unique<SpatialHash>(cellSize);
+	}
+}
+
+bool ParseBroadphaseType(const std::string& name, BroadphaseType& type)
+{
+	if (name == "hash")
+	{
+		type = BroadphaseType::SpatialHash;
+	}
+	else if (name == "sap")
+	{
+		type = BroadphaseType::SweepAndPrune;
+	}
+	else if (name == "tree")
+	{
+		type = BroadphaseType::AABBTree;
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,48 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include "AABB.h"
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Which broadphase CollisionSystem uses, picked per scene
+enum class BroadphaseType
+{
+	// Uniform grid, for many colliders of about the same size
+	SpatialHash,
+	// Sorted intervals on the x axis, for sparse maps and colliders that move little between ticks
+	SweepAndPrune,
+	// Bounding volume hierarchy, for colliders of very different sizes, doubles as the scene query structure
+	AABBTree
+};
+
+/////////////////////////
+// BROADPHASE
+// Finds the pairs of colliders whose boxes may overlap, so the narrowphase only tests those
+// The same index names the same collider from tick to tick as long as the colliders do not change,
+// broadphases exploiting frame coherence rely on it, a reused index is handled as a collider that moved
+/////////////////////////
+class IBroadphase
+{
+public:
+	virtual ~IBroadphase() = default;
+
+	virtual const char* GetName() const = 0;
+
+	// Takes the boxes of the current tick
+	virtual void Update(const std::vector<AABB>& bounds) = 0;
+
+	// Appends the candidate pairs (indices into the bounds given to Update(), lower index first)
+	// Every pair of overlapping boxes is reported exactly once
+	virtual void FindPairs(std::vector<std::pair<int, int>>& pairs) const = 0;
+};
+
+// cellSize is only used by the spatial hash
+std::unique_ptr<IBroadphase> CreateBroadphase(BroadphaseType type, float cellSize);
+
+// "hash", "sap" or "tree", returns false for an unknown name
+bool ParseBroadphaseType(const std::string& name, BroadphaseType& type);
+
+#endif
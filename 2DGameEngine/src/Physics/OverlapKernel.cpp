@@ -0,0 +1,299 @@
+#include "OverlapKernel.h"
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define OVERLAP_KERNEL_SSE2
+#define OVERLAP_KERNEL_AVX2
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// GCC and Clang only emit AVX2 instructions in functions marked for it, MSVC emits any intrinsic
+#if defined(__GNUC__)
+#define OVERLAP_KERNEL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define OVERLAP_KERNEL_TARGET_AVX2
+#endif
+
+static_assert(sizeof(std::pair<int, int>) == 2 * sizeof(int), "The AVX2 kernel loads pairs as arrays of indices");
+
+void AABBArrays::Assign(const std::vector<AABB>& bounds)
+{
+	minX.resize(bounds.size());
+	minY.resize(bounds.size());
+	maxX.resize(bounds.size());
+	maxY.resize(bounds.size());
+	for (size_t i = 0; i < bounds.size(); i++)
+	{
+		minX[i] = bounds[i].minX;
+		minY[i] = bounds[i].minY;
+		maxX[i] = bounds[i].maxX;
+		maxY[i] = bounds[i].maxY;
+	}
+}
+
+// Index of the lowest set bit, mask is not 0
+static int LowestBit(unsigned int mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+/////////////////////////
+// Scalar
+/////////////////////////
+
+static int FindOverlapsScalar(const AABB& box, const AABBArrays& boxes, int begin, int end, int* results)
+{
+	int count = 0;
+	for (int i = begin; i < end; i++)
+	{
+		if (box.minX < boxes.maxX[i] && box.maxX > boxes.minX[i] && box.minY < boxes.maxY[i] && box.maxY > boxes.minY[i])
+		{
+			results[count++] = i;
+		}
+	}
+	return count;
+}
+
+static int FilterPairsScalar(const AABBArrays& a, const AABBArrays& b, const std::pair<int, int>* pairs, int numPairs, std::pair<int, int>* results)
+{
+	// Every pair is written and only kept by moving past it, no branch to mispredict
+	int count = 0;
+	for (int i = 0; i < numPairs; i++)
+	{
+		const int first = pairs[i].first;
+		const int second = pairs[i].second;
+		results[count] = pairs[i];
+		count += a.minX[first] < b.maxX[second] && a.maxX[first] > b.minX[second] && a.minY[first] < b.maxY[second] && a.maxY[first] > b.minY[second];
+	}
+	return count;
+}
+
+/////////////////////////
+// SSE2
+/////////////////////////
+
+#ifdef OVERLAP_KERNEL_SSE2
+static int FindOverlapsSSE2(const AABB& box, const AABBArrays& boxes, int begin, int end, int* results)
+{
+	const __m128 minX = _mm_set1_ps(box.minX);
+	const __m128 minY = _mm_set1_ps(box.minY);
+	const __m128 maxX = _mm_set1_ps(box.maxX);
+	const __m128 maxY = _mm_set1_ps(box.maxY);
+
+	int count = 0;
+	int i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		const __m128 overlapX = _mm_and_ps(_mm_cmplt_ps(minX, _mm_loadu_ps(&boxes.maxX[i])), _mm_cmpgt_ps(maxX, _mm_loadu_ps(&boxes.minX[i])));
+		const __m128 overlapY = _mm_and_ps(_mm_cmplt_ps(minY, _mm_loadu_ps(&boxes.maxY[i])), _mm_cmpgt_ps(maxY, _mm_loadu_ps(&boxes.minY[i])));
+		// Most boxes overlap nothing, the mask is usually 0 and the loop below skipped
+		unsigned int mask = _mm_movemask_ps(_mm_and_ps(overlapX, overlapY));
+		while (mask)
+		{
+			results[count++] = i + LowestBit(mask);
+			mask &= mask - 1;
+		}
+	}
+	return count + FindOverlapsScalar(box, boxes, i, end, results + count);
+}
+
+static int FilterPairsSSE2(const AABBArrays& a, const AABBArrays& b, const std::pair<int, int>* pairs, int numPairs, std::pair<int, int>* results)
+{
+	int count = 0;
+	int i = 0;
+	for (; i + 4 <= numPairs; i += 4)
+	{
+		// No gather before AVX2, the four boxes of each side are loaded one by one
+		const std::pair<int, int>* p = pairs + i;
+		const __m128 aMinX = _mm_setr_ps(a.minX[p[0].first], a.minX[p[1].first], a.minX[p[2].first], a.minX[p[3].first]);
+		const __m128 aMinY = _mm_setr_ps(a.minY[p[0].first], a.minY[p[1].first], a.minY[p[2].first], a.minY[p[3].first]);
+		const __m128 aMaxX = _mm_setr_ps(a.maxX[p[0].first], a.maxX[p[1].first], a.maxX[p[2].first], a.maxX[p[3].first]);
+		const __m128 aMaxY = _mm_setr_ps(a.maxY[p[0].first], a.maxY[p[1].first], a.maxY[p[2].first], a.maxY[p[3].first]);
+		const __m128 bMinX = _mm_setr_ps(b.minX[p[0].second], b.minX[p[1].second], b.minX[p[2].second], b.minX[p[3].second]);
+		const __m128 bMinY = _mm_setr_ps(b.minY[p[0].second], b.minY[p[1].second], b.minY[p[2].second], b.minY[p[3].second]);
+		const __m128 bMaxX = _mm_setr_ps(b.maxX[p[0].second], b.maxX[p[1].second], b.maxX[p[2].second], b.maxX[p[3].second]);
+		const __m128 bMaxY = _mm_setr_ps(b.maxY[p[0].second], b.maxY[p[1].second], b.maxY[p[2].second], b.maxY[p[3].second]);
+
+		const __m128 overlapX = _mm_and_ps(_mm_cmplt_ps(aMinX, bMaxX), _mm_cmpgt_ps(aMaxX, bMinX));
+		const __m128 overlapY = _mm_and_ps(_mm_cmplt_ps(aMinY, bMaxY), _mm_cmpgt_ps(aMaxY, bMinY));
+		const int mask = _mm_movemask_ps(_mm_and_ps(overlapX, overlapY));
+
+		// Candidate pairs overlap often, compacting without branches beats skipping the zero bits
+		for (int lane = 0; lane < 4; lane++)
+		{
+			results[count] = p[lane];
+			count += (mask >> lane) & 1;
+		}
+	}
+	return count + FilterPairsScalar(a, b, pairs + i, numPairs - i, results + count);
+}
+#endif
+
+/////////////////////////
+// AVX2
+/////////////////////////
+
+#ifdef OVERLAP_KERNEL_AVX2
+OVERLAP_KERNEL_TARGET_AVX2 static unsigned int OverlapMaskAVX2(__m256 minX, __m256 minY, __m256 maxX, __m256 maxY, const AABBArrays& boxes, int i)
+{
+	const __m256 overlapX = _mm256_and_ps(_mm256_cmp_ps(minX, _mm256_loadu_ps(&boxes.maxX[i]), _CMP_LT_OQ), _mm256_cmp_ps(maxX, _mm256_loadu_ps(&boxes.minX[i]), _CMP_GT_OQ));
+	const __m256 overlapY = _mm256_and_ps(_mm256_cmp_ps(minY, _mm256_loadu_ps(&boxes.maxY[i]), _CMP_LT_OQ), _mm256_cmp_ps(maxY, _mm256_loadu_ps(&boxes.minY[i]), _CMP_GT_OQ));
+	return static_cast<unsigned int>(_mm256_movemask_ps(_mm256_and_ps(overlapX, overlapY)));
+}
+
+OVERLAP_KERNEL_TARGET_AVX2 static int FindOverlapsAVX2(const AABB& box, const AABBArrays& boxes, int begin, int end, int* results)
+{
+	const __m256 minX = _mm256_set1_ps(box.minX);
+	const __m256 minY = _mm256_set1_ps(box.minY);
+	const __m256 maxX = _mm256_set1_ps(box.maxX);
+	const __m256 maxY = _mm256_set1_ps(box.maxY);
+
+	int count = 0;
+	int i = begin;
+	// 16 boxes per iteration, the two halves are independent and their loads and compares overlap
+	for (; i + 16 <= end; i += 16)
+	{
+		unsigned int mask = OverlapMaskAVX2(minX, minY, maxX, maxY, boxes, i) | (OverlapMaskAVX2(minX, minY, maxX, maxY, boxes, i + 8) << 8);
+		while (mask)
+		{
+			results[count++] = i + LowestBit(mask);
+			mask &= mask - 1;
+		}
+	}
+	for (; i + 8 <= end; i += 8)
+	{
+		unsigned int mask = OverlapMaskAVX2(minX, minY, maxX, maxY, boxes, i);
+		while (mask)
+		{
+			results[count++] = i + LowestBit(mask);
+			mask &= mask - 1;
+		}
+	}
+	return count + FindOverlapsScalar(box, boxes, i, end, results + count);
+}
+
+OVERLAP_KERNEL_TARGET_AVX2 static int FilterPairsAVX2(const AABBArrays& a, const AABBArrays& b, const std::pair<int, int>* pairs, int numPairs, std::pair<int, int>* results)
+{
+	// Eight pairs are 16 interleaved indices, the permutes split them into the eight firsts and the eight seconds
+	const __m256i evenFirst = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+	int count = 0;
+	int i = 0;
+	for (; i + 8 <= numPairs; i += 8)
+	{
+		const int* indices = reinterpret_cast<const int*>(pairs + i);
+		const __m256i low = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices)), evenFirst);
+		const __m256i high = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + 8)), evenFirst);
+		const __m256i firsts = _mm256_permute2x128_si256(low, high, 0x20);
+		const __m256i seconds = _mm256_permute2x128_si256(low, high, 0x31);
+
+		const __m256 aMinX = _mm256_i32gather_ps(a.minX.data(), firsts, 4);
+		const __m256 aMinY = _mm256_i32gather_ps(a.minY.data(), firsts, 4);
+		const __m256 aMaxX = _mm256_i32gather_ps(a.maxX.data(), firsts, 4);
+		const __m256 aMaxY = _mm256_i32gather_ps(a.maxY.data(), firsts, 4);
+		const __m256 bMinX = _mm256_i32gather_ps(b.minX.data(), seconds, 4);
+		const __m256 bMinY = _mm256_i32gather_ps(b.minY.data(), seconds, 4);
+		const __m256 bMaxX = _mm256_i32gather_ps(b.maxX.data(), seconds, 4);
+		const __m256 bMaxY = _mm256_i32gather_ps(b.maxY.data(), seconds, 4);
+
+		const __m256 overlapX = _mm256_and_ps(_mm256_cmp_ps(aMinX, bMaxX, _CMP_LT_OQ), _mm256_cmp_ps(aMaxX, bMinX, _CMP_GT_OQ));
+		const __m256 overlapY = _mm256_and_ps(_mm256_cmp_ps(aMinY, bMaxY, _CMP_LT_OQ), _mm256_cmp_ps(aMaxY, bMinY, _CMP_GT_OQ));
+		const int mask = _mm256_movemask_ps(_mm256_and_ps(overlapX, overlapY));
+
+		for (int lane = 0; lane < 8; lane++)
+		{
+			results[count] = pairs[i + lane];
+			count += (mask >> lane) & 1;
+		}
+	}
+	return count + FilterPairsScalar(a, b, pairs + i, numPairs - i, results + count);
+}
+#endif
+
+/////////////////////////
+// Dispatch
+/////////////////////////
+
+// AVX2 takes the processor to have the instructions and the operating system to save the 256-bit registers
+static bool DetectAVX2()
+{
+#if !defined(OVERLAP_KERNEL_AVX2)
+	return false;
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+	{
+		return false;
+	}
+	__cpuid(info, 1);
+	const bool hasOSXSave = (info[2] & (1 << 27)) != 0;
+	const bool hasAVX = (info[2] & (1 << 28)) != 0;
+	if (!hasOSXSave || !hasAVX || (_xgetbv(0) & 6) != 6)
+	{
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	// Checks the operating system support as well
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static const OverlapKernel overlapKernels[] = {
+	{ OverlapKernelType::Scalar, "scalar", 1, FindOverlapsScalar, FilterPairsScalar },
+#ifdef OVERLAP_KERNEL_SSE2
+	{ OverlapKernelType::SSE2, "sse2", 4, FindOverlapsSSE2, FilterPairsSSE2 },
+#else
+	{ OverlapKernelType::SSE2, "sse2", 1, FindOverlapsScalar, FilterPairsScalar },
+#endif
+#ifdef OVERLAP_KERNEL_AVX2
+	{ OverlapKernelType::AVX2, "avx2", 8, FindOverlapsAVX2, FilterPairsAVX2 }
+#else
+	{ OverlapKernelType::AVX2, "avx2", 1, FindOverlapsScalar, FilterPairsScalar }
+#endif
+};
+
+bool IsOverlapKernelSupported(OverlapKernelType type)
+{
+	static const bool hasAVX2 = DetectAVX2();
+	switch (type)
+	{
+		case OverlapKernelType::AVX2:
+			return hasAVX2;
+		case OverlapKernelType::SSE2:
+#ifdef OVERLAP_KERNEL_SSE2
+			return true;
+#else
+			return false;
+#endif
+		case OverlapKernelType::Scalar:
+		default:
+			return true;
+	}
+}
+
+const OverlapKernel& GetOverlapKernel()
+{
+	static const OverlapKernel& kernel = IsOverlapKernelSupported(OverlapKernelType::AVX2) ? overlapKernels[2]
+		: IsOverlapKernelSupported(OverlapKernelType::SSE2) ? overlapKernels[1]
+		: overlapKernels[0];
+	return kernel;
+}
+
+const OverlapKernel& GetOverlapKernel(OverlapKernelType type)
+{
+	return IsOverlapKernelSupported(type) ? overlapKernels[static_cast<int>(type)] : overlapKernels[0];
+}
@@ -0,0 +1,61 @@
+#ifndef OVERLAPKERNEL_H
+#define OVERLAPKERNEL_H
+
+#include "AABB.h"
+#include <utility>
+#include <vector>
+
+// Boxes stored one array per side, so a kernel loads the same side of several boxes with one instruction
+struct AABBArrays
+{
+	std::vector<float> minX;
+	std::vector<float> minY;
+	std::vector<float> maxX;
+	std::vector<float> maxY;
+
+	void Assign(const std::vector<AABB>& bounds);
+	int GetSize() const { return static_cast<int>(minX.size()); }
+	AABB Get(int index) const { return AABB(minX[index], minY[index], maxX[index], maxY[index]); }
+};
+
+// Instruction set of a kernel, from the slowest to the fastest
+enum class OverlapKernelType
+{
+	Scalar,
+	SSE2,
+	AVX2
+};
+
+/////////////////////////
+// OVERLAP KERNEL
+// Tests several boxes at once with the strict test of AABB::Overlaps(): 4 per instruction with SSE2, 8 with AVX2,
+// and the AVX2 scan goes through 16 boxes per iteration
+// Every kernel is compiled into the engine, GetOverlapKernel() picks the fastest one the processor runs,
+// the scalar one when it is not an x86 processor
+// Results are written compactly, only the overlapping indices or pairs in their original order, and their count returned
+// Example: int numColliding = GetOverlapKernel().filterPairs(arrays, arrays, pairs.data(), numPairs, colliding.data());
+/////////////////////////
+struct OverlapKernel
+{
+	OverlapKernelType type;
+	const char* name;
+	// Boxes tested by one instruction
+	int width;
+
+	// Writes the index of every box of boxes[begin, end) that overlaps box to results, which must hold end - begin indices
+	int (*findOverlaps)(const AABB& box, const AABBArrays& boxes, int begin, int end, int* results);
+
+	// Writes the pairs (index into a, index into b) whose boxes overlap to results, which must hold numPairs pairs
+	// a and b may be the same arrays, and results may be pairs itself to filter them in place
+	int (*filterPairs)(const AABBArrays& a, const AABBArrays& b, const std::pair<int, int>* pairs, int numPairs, std::pair<int, int>* results);
+};
+
+bool IsOverlapKernelSupported(OverlapKernelType type);
+
+// Fastest kernel the processor supports, detected on the first call
+const OverlapKernel& GetOverlapKernel();
+
+// The kernel for this instruction set, or the scalar one if the processor does not support it
+const OverlapKernel& GetOverlapKernel(OverlapKernelType type);
+
+#endif
@@ -0,0 +1,106 @@
+#include "SpatialHash.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+	uint32_t HashCell(int cellX, int cellY)
+	{
+		return static_cast<uint32_t>(cellX) * 73856093u ^ static_cast<uint32_t>(cellY) * 19349663u;
+	}
+}
+
+SpatialHash::SpatialHash(float cellSize)
+{
+	SetCellSize(cellSize);
+}
+
+void SpatialHash::SetCellSize(float cellSize)
+{
+	this->cellSize = std::max(cellSize, 1.0f);
+}
+
+int SpatialHash::GetCell(float coordinate) const
+{
+	return static_cast<int>(std::floor(coordinate / cellSize));
+}
+
+void SpatialHash::Update(const std::vector<AABB>& bounds)
+{
+	entries.clear();
+	for (int i = 0; i < static_cast<int>(bounds.size()); i++)
+	{
+		const AABB& box = bounds[i];
+		const int lastCellX = GetCell(box.maxX);
+		const int lastCellY = GetCell(box.maxY);
+		for (int cellY = GetCell(box.minY); cellY <= lastCellY; cellY++)
+		{
+			for (int cellX = GetCell(box.minX); cellX <= lastCellX; cellX++)
+			{
+				entries.push_back({ cellX, cellY, i, box.minX, box.minY });
+			}
+		}
+	}
+
+	// Twice as many buckets as entries, a power of two so the hash is masked instead of divided
+	size_t numBuckets = 64;
+	while (numBuckets < entries.size() * 2)
+	{
+		numBuckets *= 2;
+	}
+	const uint32_t mask = static_cast<uint32_t>(numBuckets - 1);
+
+	// Counting sort of the entries by bucket
+	bucketStarts.assign(numBuckets + 1, 0);
+	for (const auto& entry : entries)
+	{
+		bucketStarts[(HashCell(entry.cellX, entry.cellY) & mask) + 1]++;
+	}
+	for (size_t bucket = 0; bucket < numBuckets; bucket++)
+	{
+		bucketStarts[bucket + 1] += bucketStarts[bucket];
+	}
+	entriesByBucket.resize(entries.size());
+	std::vector<int>& nextSlots = bucketStarts;
+	for (const auto& entry : entries)
+	{
+		entriesByBucket[nextSlots[HashCell(entry.cellX, entry.cellY) & mask]++] = entry;
+	}
+	// Filling the buckets moved every start to the start of the next bucket, shift them back
+	for (size_t bucket = numBuckets; bucket > 0; bucket--)
+	{
+		bucketStarts[bucket] = bucketStarts[bucket - 1];
+	}
+	bucketStarts[0] = 0;
+}
+
+void SpatialHash::FindPairs(std::vector<std::pair<int, int>>& pairs) const
+{
+	for (size_t bucket = 0; bucket + 1 < bucketStarts.size(); bucket++)
+	{
+		const int end = bucketStarts[bucket + 1];
+		for (int i = bucketStarts[bucket]; i < end; i++)
+		{
+			const CellEntry& a = entriesByBucket[i];
+			for (int j = i + 1; j < end; j++)
+			{
+				const CellEntry& b = entriesByBucket[j];
+				// Another cell that hashed to the same bucket
+				if (a.cellX != b.cellX || a.cellY != b.cellY)
+				{
+					continue;
+				}
+
+				// Two boxes can share several cells, the pair is only reported from the cell holding the
+				// top-left corner of their overlap, which both boxes cover whenever they overlap
+				if (GetCell(std::max(a.minX, b.minX)) != a.cellX || GetCell(std::max(a.minY, b.minY)) != a.cellY)
+				{
+					continue;
+				}
+
+				pairs.emplace_back(std::min(a.index, b.index), std::max(a.index, b.index));
+			}
+		}
+	}
+}
@@ -0,0 +1,53 @@
+#ifndef SPATIALHASH_H
+#define SPATIALHASH_H
+
+#include "Broadphase.h"
+
+// About twice the size of the usual 32x32 collider, so most boxes cover one to four cells
+const float DEFAULT_COLLISION_CELL_SIZE = 64.0f;
+
+/////////////////////////
+// SPATIAL HASH
+// Uniform grid broadphase, rebuilt from scratch from the boxes of the current tick
+// Every box is entered in each cell it covers, the cells are hashed into a table sized after the number of entries
+// and the entries are grouped by bucket with a counting sort, so building and querying are linear in the number of boxes
+// Only boxes sharing a cell become candidate pairs
+// Example: spatialHash.Update(bounds); spatialHash.FindPairs(pairs);
+/////////////////////////
+class SpatialHash : public IBroadphase
+{
+private:
+	struct CellEntry
+	{
+		int cellX;
+		int cellY;
+		int index;
+		// Top-left corner of the box, to report a pair from one of its shared cells only
+		float minX;
+		float minY;
+	};
+
+	float cellSize;
+	std::vector<CellEntry> entries;
+	// Entries grouped by bucket, a bucket can hold several cells
+	std::vector<CellEntry> entriesByBucket;
+	// [index = bucket] first entry of the bucket in entriesByBucket, one more for the end of the last bucket
+	std::vector<int> bucketStarts;
+
+	int GetCell(float coordinate) const;
+
+public:
+	SpatialHash(float cellSize = DEFAULT_COLLISION_CELL_SIZE);
+
+	void SetCellSize(float cellSize);
+	float GetCellSize() const { return cellSize; }
+
+	const char* GetName() const override { return "spatial hash"; }
+
+	void Update(const std::vector<AABB>& bounds) override;
+
+	// A pair that shares a cell without overlapping is reported at most once
+	void FindPairs(std::vector<std::pair<int, int>>& pairs) const override;
+};
+
+#endif
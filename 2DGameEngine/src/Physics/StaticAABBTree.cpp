@@ -0,0 +1,72 @@
+#include "StaticAABBTree.h"
+#include <algorithm>
+#include <numeric>
+
+void StaticAABBTree::Build(const std::vector<AABB>& bounds)
+{
+	Clear();
+	if (bounds.empty())
+	{
+		return;
+	}
+
+	// Leaves hold at least two boxes once there are two of them, the tree has fewer nodes than boxes
+	indices.resize(bounds.size());
+	std::iota(indices.begin(), indices.end(), 0);
+	nodes.reserve(bounds.size());
+	BuildNode(bounds, 0, static_cast<int>(bounds.size()), 0);
+
+	boxes.reserve(bounds.size());
+	for (int index : indices)
+	{
+		boxes.push_back(bounds[index]);
+	}
+}
+
+void StaticAABBTree::Clear()
+{
+	nodes.clear();
+	boxes.clear();
+	indices.clear();
+	height = 0;
+}
+
+int StaticAABBTree::BuildNode(const std::vector<AABB>& bounds, int begin, int end, int depth)
+{
+	const int index = static_cast<int>(nodes.size());
+	nodes.emplace_back();
+
+	AABB box = bounds[indices[begin]];
+	AABB centers(box.minX + box.maxX, box.minY + box.maxY, box.minX + box.maxX, box.minY + box.maxY);
+	for (int i = begin + 1; i < end; i++)
+	{
+		const AABB& other = bounds[indices[i]];
+		box = AABB::Union(box, other);
+		const float centerX = other.minX + other.maxX;
+		const float centerY = other.minY + other.maxY;
+		centers = AABB::Union(centers, AABB(centerX, centerY, centerX, centerY));
+	}
+	nodes[index].box = box;
+	height = std::max(height, depth);
+
+	if (end - begin <= STATIC_AABB_TREE_LEAF_SIZE)
+	{
+		nodes[index].first = begin;
+		nodes[index].count = end - begin;
+		return index;
+	}
+
+	// Half the boxes on each side of the median center along the axis the centers spread the most
+	const int middle = begin + (end - begin) / 2;
+	const bool splitX = centers.GetWidth() >= centers.GetHeight();
+	std::nth_element(indices.begin() + begin, indices.begin() + middle, indices.begin() + end, [&bounds, splitX](int a, int b)
+	{
+		return splitX
+			? bounds[a].minX + bounds[a].maxX < bounds[b].minX + bounds[b].maxX
+			: bounds[a].minY + bounds[a].maxY < bounds[b].minY + bounds[b].maxY;
+	});
+
+	BuildNode(bounds, begin, middle, depth + 1);
+	nodes[index].first = BuildNode(bounds, middle, end, depth + 1);
+	return index;
+}
@@ -0,0 +1,179 @@
+#ifndef STATICAABBTREE_H
+#define STATICAABBTREE_H
+
+#include "AABB.h"
+#include "AABBTree.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+// Boxes held by a leaf of the static tree, tested one after the other
+const int STATIC_AABB_TREE_LEAF_SIZE = 4;
+
+/////////////////////////
+// STATIC AABB TREE
+// Bounding volume hierarchy baked once from boxes that never move: walls, trees, buildings
+// Built top-down by splitting the boxes at the median of the longest axis, the nodes are stored depth first
+// in one array (the first child of a node right after it) and the boxes of each leaf are contiguous
+// Nothing is inserted or removed afterwards, a changed set of boxes takes a new Build()
+// Example: staticTree.Build(wallBounds); staticTree.QueryAABB(box, [](int wallIndex) { ...; return true; });
+/////////////////////////
+class StaticAABBTree
+{
+private:
+	struct Node
+	{
+		AABB box;
+		// Leaves: first box in boxes, internal nodes: second child (the first child is the next node)
+		int first = 0;
+		// Boxes of a leaf, 0 for internal nodes
+		int count = 0;
+	};
+
+	std::vector<Node> nodes;
+	// Boxes in leaf order, and the index each one had in the bounds given to Build()
+	std::vector<AABB> boxes;
+	std::vector<int> indices;
+	// Levels below the root, 0 for a single leaf
+	int height = 0;
+
+	// Appends the subtree of indices[begin, end) at depth and returns its node
+	int BuildNode(const std::vector<AABB>& bounds, int begin, int end, int depth);
+
+public:
+	// Replaces the tree with one over these boxes, the queries hand back indices into bounds
+	void Build(const std::vector<AABB>& bounds);
+	void Clear();
+
+	int GetNumBoxes() const { return static_cast<int>(boxes.size()); }
+	int GetNumNodes() const { return static_cast<int>(nodes.size()); }
+	int GetHeight() const { return height; }
+
+	// Same queries as DynamicAABBTree, with the indices given to Build()
+	template <typename TCallback>
+	void QueryAABB(const AABB& area, TCallback callback) const;
+
+	template <typename TCallback>
+	void QueryPoint(glm::vec2 point, TCallback callback) const;
+
+	template <typename TFilter>
+	RaycastHit Raycast(glm::vec2 origin, glm::vec2 direction, float maxDistance, TFilter filter) const;
+};
+
+template <typename TCallback>
+void StaticAABBTree::QueryAABB(const AABB& area, TCallback callback) const
+{
+	if (nodes.empty())
+	{
+		return;
+	}
+
+	AABBTreeStack stack(height);
+	stack.Push(0);
+	while (!stack.IsEmpty())
+	{
+		const int index = stack.Pop();
+		const Node& node = nodes[index];
+		if (!node.box.Overlaps(area))
+		{
+			continue;
+		}
+		if (node.count > 0)
+		{
+			for (int i = node.first; i < node.first + node.count; i++)
+			{
+				if (boxes[i].Overlaps(area) && !callback(indices[i]))
+				{
+					return;
+				}
+			}
+		}
+		else
+		{
+			stack.Push(node.first);
+			stack.Push(index + 1);
+		}
+	}
+}
+
+template <typename TCallback>
+void StaticAABBTree::QueryPoint(glm::vec2 point, TCallback callback) const
+{
+	if (nodes.empty())
+	{
+		return;
+	}
+
+	AABBTreeStack stack(height);
+	stack.Push(0);
+	while (!stack.IsEmpty())
+	{
+		const int index = stack.Pop();
+		const Node& node = nodes[index];
+		if (!node.box.Contains(point.x, point.y))
+		{
+			continue;
+		}
+		if (node.count > 0)
+		{
+			for (int i = node.first; i < node.first + node.count; i++)
+			{
+				if (boxes[i].Contains(point.x, point.y) && !callback(indices[i]))
+				{
+					return;
+				}
+			}
+		}
+		else
+		{
+			stack.Push(node.first);
+			stack.Push(index + 1);
+		}
+	}
+}
+
+template <typename TFilter>
+RaycastHit StaticAABBTree::Raycast(glm::vec2 origin, glm::vec2 direction, float maxDistance, TFilter filter) const
+{
+	RaycastHit hit;
+	const float length = glm::length(direction);
+	if (nodes.empty() || length == 0.0f)
+	{
+		return hit;
+	}
+	direction /= length;
+
+	float closestDistance = maxDistance;
+	AABBTreeStack stack(height);
+	stack.Push(0);
+	while (!stack.IsEmpty())
+	{
+		const int index = stack.Pop();
+		const Node& node = nodes[index];
+		float distance;
+		if (!IntersectRay(node.box, origin, direction, closestDistance, distance))
+		{
+			continue;
+		}
+		if (node.count > 0)
+		{
+			for (int i = node.first; i < node.first + node.count; i++)
+			{
+				if (IntersectRay(boxes[i], origin, direction, closestDistance, distance) && filter(indices[i]))
+				{
+					closestDistance = distance;
+					hit.userData = indices[i];
+					hit.distance = distance;
+					hit.point = origin + direction * distance;
+				}
+			}
+		}
+		else
+		{
+			stack.Push(node.first);
+			stack.Push(index + 1);
+		}
+	}
+	return hit;
+}
+
+#endif
@@ -0,0 +1,81 @@
+#include "SweepAndPrune.h"
+#include <algorithm>
+
+void SweepAndPrune::Update(const std::vector<AABB>& newBounds)
+{
+	const int numBoxes = static_cast<int>(newBounds.size());
+	const int numOldBoxes = static_cast<int>(bounds.size());
+	bounds = newBounds;
+
+	if (numBoxes < numOldBoxes)
+	{
+		endpoints.erase(std::remove_if(endpoints.begin(), endpoints.end(), [numBoxes](const Endpoint& endpoint) { return endpoint.GetIndex() >= numBoxes; }), endpoints.end());
+	}
+
+	for (auto& endpoint : endpoints)
+	{
+		const AABB& box = bounds[endpoint.GetIndex()];
+		endpoint.value = endpoint.IsStart() ? box.minX : box.maxX;
+	}
+
+	for (int i = numOldBoxes; i < numBoxes; i++)
+	{
+		endpoints.push_back({ bounds[i].minX, static_cast<uint32_t>(i) << 1 | 1 });
+		endpoints.push_back({ bounds[i].maxX, static_cast<uint32_t>(i) << 1 });
+	}
+
+	// Many new boxes land anywhere in the list, a full sort is cheaper than shifting each of them into place
+	if (numBoxes - numOldBoxes > numBoxes / 8)
+	{
+		std::sort(endpoints.begin(), endpoints.end());
+		return;
+	}
+
+	// Insertion sort, each endpoint only moves past the few it crossed since the last tick
+	for (size_t i = 1; i < endpoints.size(); i++)
+	{
+		const Endpoint endpoint = endpoints[i];
+		size_t j = i;
+		while (j > 0 && endpoint < endpoints[j - 1])
+		{
+			endpoints[j] = endpoints[j - 1];
+			j--;
+		}
+		endpoints[j] = endpoint;
+	}
+}
+
+void SweepAndPrune::FindPairs(std::vector<std::pair<int, int>>& pairs) const
+{
+	openBoxes.clear();
+	openPositions.resize(bounds.size());
+
+	for (const auto& endpoint : endpoints)
+	{
+		const int index = endpoint.GetIndex();
+		if (endpoint.IsStart())
+		{
+			// The x intervals of the open boxes overlap this one, prune on y before reporting
+			const AABB& box = bounds[index];
+			for (int other : openBoxes)
+			{
+				const AABB& otherBox = bounds[other];
+				if (box.minY < otherBox.maxY && box.maxY > otherBox.minY)
+				{
+					pairs.emplace_back(std::min(index, other), std::max(index, other));
+				}
+			}
+			openPositions[index] = static_cast<int>(openBoxes.size());
+			openBoxes.push_back(index);
+		}
+		else
+		{
+			// Swap with the last open box so closing is constant time
+			const int position = openPositions[index];
+			const int last = openBoxes.back();
+			openBoxes[position] = last;
+			openPositions[last] = position;
+			openBoxes.pop_back();
+		}
+	}
+}
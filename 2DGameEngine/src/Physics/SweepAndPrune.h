@@ -0,0 +1,48 @@
+#ifndef SWEEPANDPRUNE_H
+#define SWEEPANDPRUNE_H
+
+#include "Broadphase.h"
+#include <cstdint>
+
+/////////////////////////
+// SWEEP AND PRUNE
+// Keeps the start and end of every box on the x axis in one sorted list from tick to tick
+// Colliders move little between ticks, so the list is nearly sorted and an insertion sort puts it back in order in about linear time
+// The sweep walks the list keeping the boxes whose x interval is open, and pairs a starting box
+// with the open ones its y interval overlaps as well
+// Colliders bunched on the x axis (a column, a dense cluster) keep many intervals open, the spatial hash suits them better
+/////////////////////////
+class SweepAndPrune : public IBroadphase
+{
+private:
+	struct Endpoint
+	{
+		float value;
+		// Index of the box, with the lowest bit set for the start of its interval
+		uint32_t data;
+
+		int GetIndex() const { return static_cast<int>(data >> 1); }
+		bool IsStart() const { return data & 1; }
+
+		// At the same x a start comes before an end, so a box without width still opens before it closes
+		bool operator<(const Endpoint& other) const
+		{
+			return value < other.value || (value == other.value && (data & 1) > (other.data & 1));
+		}
+	};
+
+	std::vector<Endpoint> endpoints;
+	std::vector<AABB> bounds;
+
+	// Boxes whose interval is open during the sweep, and where each one sits in it
+	mutable std::vector<int> openBoxes;
+	mutable std::vector<int> openPositions;
+
+public:
+	const char* GetName() const override { return "sweep and prune"; }
+
+	void Update(const std::vector<AABB>& bounds) override;
+	void FindPairs(std::vector<std::pair<int, int>>& pairs) const override;
+};
+
+#endif
@@ -0,0 +1,206 @@
+#include "HitchLog.h"
+#include "../Logger/Logger.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+
+namespace
+{
+	const char HITCH_LOG_MAGIC[4] = { 'H', 'T', 'C', 'H' };
+	const uint32_t HITCH_LOG_VERSION = 1;
+
+	template <typename T>
+	void WriteValue(std::ofstream& file, T value)
+	{
+		file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	bool ReadValue(std::ifstream& file, T& value)
+	{
+		return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+	}
+
+	bool ReadRecord(std::ifstream& file, HitchRecord& record)
+	{
+		uint16_t numScopes = 0;
+		if (!ReadValue(file, record.frameNumber) || !ReadValue(file, record.tickNumber) || !ReadValue(file, record.frameMilliseconds) ||
+			!ReadValue(file, record.numTicks) || !ReadValue(file, record.numEntitiesCreated) || !ReadValue(file, record.numEntitiesKilled) ||
+			!ReadValue(file, record.numEvents) || !ReadValue(file, record.numAssetsLoaded) || !ReadValue(file, numScopes))
+		{
+			return false;
+		}
+
+		record.scopes.resize(numScopes);
+		for (auto& scope : record.scopes)
+		{
+			uint8_t nameLength = 0;
+			if (!ReadValue(file, nameLength))
+			{
+				return false;
+			}
+			scope.name.resize(nameLength);
+			if (!file.read(&scope.name[0], nameLength) || !ReadValue(file, scope.milliseconds))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+void HitchLog::Append(const HitchRecord& record)
+{
+	if (path.empty())
+	{
+		return;
+	}
+
+	if (!file.is_open())
+	{
+		file.open(path, std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			Logger::Err("Cannot write hitch log to " + path);
+			path.clear();
+			return;
+		}
+		file.write(HITCH_LOG_MAGIC, sizeof(HITCH_LOG_MAGIC));
+		WriteValue(file, HITCH_LOG_VERSION);
+	}
+
+	WriteValue(file, record.frameNumber);
+	WriteValue(file, record.tickNumber);
+	WriteValue(file, record.frameMilliseconds);
+	WriteValue(file, record.numTicks);
+	WriteValue(file, record.numEntitiesCreated);
+	WriteValue(file, record.numEntitiesKilled);
+	WriteValue(file, record.numEvents);
+	WriteValue(file, record.numAssetsLoaded);
+
+	const size_t numScopes = std::min<size_t>(record.scopes.size(), HITCH_MAX_SCOPES);
+	WriteValue(file, static_cast<uint16_t>(numScopes));
+	for (size_t i = 0; i < numScopes; i++)
+	{
+		const HitchScope& scope = record.scopes[i];
+		const uint8_t nameLength = static_cast<uint8_t>(std::min<size_t>(scope.name.size(), 255));
+		WriteValue(file, nameLength);
+		file.write(scope.name.data(), nameLength);
+		WriteValue(file, scope.milliseconds);
+	}
+	file.flush();
+
+	numRecords++;
+}
+
+bool HitchLog::Read(const std::string& path, std::vector<HitchRecord>& records)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+	{
+		Logger::Err("Cannot open hitch log " + path);
+		return false;
+	}
+
+	char magic[sizeof(HITCH_LOG_MAGIC)];
+	uint32_t version = 0;
+	if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, HITCH_LOG_MAGIC, sizeof(magic)) != 0 || !ReadValue(file, version) || version != HITCH_LOG_VERSION)
+	{
+		Logger::Err(path + " is not a hitch log");
+		return false;
+	}
+
+	HitchRecord record;
+	while (ReadRecord(file, record))
+	{
+		records.push_back(record);
+	}
+	return true;
+}
+
+bool PrintHitchReport(const std::string& path, int numTopEntries)
+{
+	std::vector<HitchRecord> records;
+	if (!HitchLog::Read(path, records))
+	{
+		return false;
+	}
+	if (records.empty())
+	{
+		std::printf("%s: no slow frames\n", path.c_str());
+		return true;
+	}
+
+	double totalMilliseconds = 0.0;
+	int numWithChurn = 0;
+	int numWithEvents = 0;
+	int numWithAssetLoads = 0;
+	for (const auto& record : records)
+	{
+		totalMilliseconds += record.frameMilliseconds;
+		numWithChurn += record.numEntitiesCreated > 0 || record.numEntitiesKilled > 0;
+		numWithEvents += record.numEvents > 0;
+		numWithAssetLoads += record.numAssetsLoaded > 0;
+	}
+
+	std::vector<const HitchRecord*> worstFrames;
+	for (const auto& record : records)
+	{
+		worstFrames.push_back(&record);
+	}
+	std::sort(worstFrames.begin(), worstFrames.end(), [](const HitchRecord* a, const HitchRecord* b) { return a->frameMilliseconds > b->frameMilliseconds; });
+
+	std::printf("%s: %d slow frames, average %.2f ms, worst %.2f ms\n", path.c_str(), static_cast<int>(records.size()),
+		totalMilliseconds / records.size(), worstFrames.front()->frameMilliseconds);
+	std::printf("  %d with entity churn, %d with events, %d with asset loads\n\n", numWithChurn, numWithEvents, numWithAssetLoads);
+
+	std::printf("Worst frames:\n");
+	for (size_t i = 0; i < worstFrames.size() && i < static_cast<size_t>(numTopEntries); i++)
+	{
+		const HitchRecord& record = *worstFrames[i];
+		std::printf("  frame %-8llu %8.2f ms  %u ticks  +%u/-%u entities  %u events  %u asset loads\n", static_cast<unsigned long long>(record.frameNumber),
+			record.frameMilliseconds, record.numTicks, record.numEntitiesCreated, record.numEntitiesKilled, record.numEvents, record.numAssetsLoaded);
+		for (size_t scope = 0; scope < record.scopes.size() && scope < 3; scope++)
+		{
+			std::printf("      %-32s %8.2f ms\n", record.scopes[scope].name.c_str(), record.scopes[scope].milliseconds);
+		}
+	}
+
+	// Time of every scope summed over the slow frames
+	struct Offender
+	{
+		std::string name;
+		int numFrames = 0;
+		double totalMilliseconds = 0.0;
+		double maxMilliseconds = 0.0;
+	};
+	std::map<std::string, Offender> offendersByName;
+	for (const auto& record : records)
+	{
+		for (const auto& scope : record.scopes)
+		{
+			Offender& offender = offendersByName[scope.name];
+			offender.name = scope.name;
+			offender.numFrames++;
+			offender.totalMilliseconds += scope.milliseconds;
+			offender.maxMilliseconds = std::max<double>(offender.maxMilliseconds, scope.milliseconds);
+		}
+	}
+	std::vector<Offender> offenders;
+	for (const auto& offender : offendersByName)
+	{
+		offenders.push_back(offender.second);
+	}
+	std::sort(offenders.begin(), offenders.end(), [](const Offender& a, const Offender& b) { return a.totalMilliseconds > b.totalMilliseconds; });
+
+	// Scopes nest, the frame scopes (Game::Run, Game::Update...) include the ones they call
+	std::printf("\nTop offenders:\n  %-32s %8s %12s %10s %10s\n", "scope", "frames", "total ms", "avg ms", "max ms");
+	for (size_t i = 0; i < offenders.size() && i < static_cast<size_t>(numTopEntries); i++)
+	{
+		const Offender& offender = offenders[i];
+		std::printf("  %-32s %8d %12.2f %10.2f %10.2f\n", offender.name.c_str(), offender.numFrames, offender.totalMilliseconds,
+			offender.totalMilliseconds / offender.numFrames, offender.maxMilliseconds);
+	}
+	return true;
+}
@@ -0,0 +1,65 @@
+#ifndef HITCHLOG_H
+#define HITCHLOG_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Scopes kept per slow frame, the slowest ones
+const int HITCH_MAX_SCOPES = 32;
+
+// Time spent in one timed scope during a slow frame, summed over the ticks of the frame
+struct HitchScope
+{
+	std::string name;
+	float milliseconds = 0.0f;
+};
+
+// What happened during a frame that went over its budget
+struct HitchRecord
+{
+	uint64_t frameNumber = 0;
+	uint64_t tickNumber = 0;
+	// Work done in the frame, without the wait for the next frame
+	float frameMilliseconds = 0.0f;
+	uint32_t numTicks = 0;
+	uint32_t numEntitiesCreated = 0;
+	uint32_t numEntitiesKilled = 0;
+	uint32_t numEvents = 0;
+	uint32_t numAssetsLoaded = 0;
+	// Slowest first
+	std::vector<HitchScope> scopes;
+};
+
+/////////////////////////
+// HITCH LOG
+// Binary file of the frames that missed their budget, every record is flushed as soon as it is
+// appended so the log survives a crash. The file is only created by the first hitch
+// Layout, little endian: "HTCH", uint32 version, then the records one after another:
+//   uint64 frame, uint64 tick, float ms, uint32 ticks, created, killed, events, assets,
+//   uint16 number of scopes, then per scope: uint8 name length, name, float ms
+/////////////////////////
+class HitchLog
+{
+private:
+	std::string path;
+	std::ofstream file;
+	int numRecords = 0;
+
+public:
+	// An empty path disables the log
+	void SetPath(const std::string& path) { this->path = path; }
+	bool IsEnabled() const { return !path.empty(); }
+
+	void Append(const HitchRecord& record);
+	int GetNumRecords() const { return numRecords; }
+
+	// Reads every complete record of a log, a record cut short by a crash is dropped
+	static bool Read(const std::string& path, std::vector<HitchRecord>& records);
+};
+
+// Prints the worst frames of a hitch log and the scopes that cost the most over all of them
+bool PrintHitchReport(const std::string& path, int numTopEntries = 10);
+
+#endif
@@ -0,0 +1,70 @@
+#include "MemoryStats.h"
+#include "../Logger/Logger.h"
+#include <algorithm>
+#include <cstdio>
+
+void MemoryReport::Add(const std::string& category, const std::string& name, size_t usedBytes, size_t capacityBytes)
+{
+	MemoryEntry entry;
+	entry.category = category;
+	entry.name = name;
+	entry.usedBytes = usedBytes;
+	entry.capacityBytes = capacityBytes;
+	entries.push_back(entry);
+}
+
+size_t MemoryReport::GetTotalUsedBytes() const
+{
+	size_t total = 0;
+	for (const auto& entry : entries)
+	{
+		total += entry.usedBytes;
+	}
+	return total;
+}
+
+size_t MemoryReport::GetTotalCapacityBytes() const
+{
+	size_t total = 0;
+	for (const auto& entry : entries)
+	{
+		total += entry.capacityBytes;
+	}
+	return total;
+}
+
+void MemoryTracker::Track(MemoryReport& report)
+{
+	for (auto& entry : report.GetEntries())
+	{
+		size_t& highWater = highWaterBytes[entry.category + "/" + entry.name];
+		highWater = std::max(highWater, entry.capacityBytes);
+		entry.highWaterBytes = highWater;
+	}
+	totalHighWaterBytes = std::max(totalHighWaterBytes, report.GetTotalCapacityBytes());
+}
+
+void CollectLoggerMemoryStats(MemoryReport& report)
+{
+	size_t usedBytes, capacityBytes;
+	Logger::GetMemoryUse(usedBytes, capacityBytes);
+	report.Add("log", "Logger::messages", usedBytes, capacityBytes);
+}
+
+std::string FormatBytes(size_t bytes)
+{
+	char text[32];
+	if (bytes >= 1024 * 1024)
+	{
+		std::snprintf(text, sizeof(text), "%.1f MB", bytes / (1024.0 * 1024.0));
+	}
+	else if (bytes >= 1024)
+	{
+		std::snprintf(text, sizeof(text), "%.1f KB", bytes / 1024.0);
+	}
+	else
+	{
+		std::snprintf(text, sizeof(text), "%d B", static_cast<int>(bytes));
+	}
+	return text;
+}
@@ -0,0 +1,55 @@
+#ifndef MEMORYSTATS_H
+#define MEMORYSTATS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+struct MemoryEntry
+{
+	// What holds the memory: "component pool", "system", "texture"...
+	std::string category;
+	std::string name;
+	size_t usedBytes = 0;
+	size_t capacityBytes = 0;
+	// Largest capacity seen for this entry, filled by MemoryTracker
+	size_t highWaterBytes = 0;
+};
+
+// Memory held by the engine at one point in time, every subsystem adds its own entries
+class MemoryReport
+{
+private:
+	std::vector<MemoryEntry> entries;
+
+public:
+	void Add(const std::string& category, const std::string& name, size_t usedBytes, size_t capacityBytes);
+	void Clear() { entries.clear(); }
+
+	const std::vector<MemoryEntry>& GetEntries() const { return entries; }
+	std::vector<MemoryEntry>& GetEntries() { return entries; }
+
+	size_t GetTotalUsedBytes() const;
+	size_t GetTotalCapacityBytes() const;
+};
+
+// Remembers the largest capacity every entry and the whole engine ever reached
+class MemoryTracker
+{
+private:
+	// [key = category/name]
+	std::map<std::string, size_t> highWaterBytes;
+	size_t totalHighWaterBytes = 0;
+
+public:
+	void Track(MemoryReport& report);
+	size_t GetTotalHighWaterBytes() const { return totalHighWaterBytes; }
+};
+
+// Bytes held by the log history (Logger::messages)
+void CollectLoggerMemoryStats(MemoryReport& report);
+
+// "1.5 MB"
+std::string FormatBytes(size_t bytes);
+
+#endif
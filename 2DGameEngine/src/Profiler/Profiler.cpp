@@ -0,0 +1,101 @@
+#include "Profiler.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+
+ProfileFrame Profiler::frames[PROFILER_HISTORY_FRAMES];
+std::atomic<uint64_t> Profiler::currentFrame{ 0 };
+std::chrono::steady_clock::time_point Profiler::frameStart;
+
+void Profiler::BeginFrame()
+{
+	// Reuse the oldest frame of the ring
+	ProfileFrame& frame = frames[currentFrame % PROFILER_HISTORY_FRAMES];
+	frame.frameNumber = currentFrame;
+	frame.frameMilliseconds = 0.0;
+	frame.numSamples.store(0, std::memory_order_relaxed);
+	frameStart = std::chrono::steady_clock::now();
+}
+
+void Profiler::EndFrame()
+{
+	ProfileFrame& frame = frames[currentFrame % PROFILER_HISTORY_FRAMES];
+	frame.frameMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+	currentFrame.fetch_add(1, std::memory_order_release);
+}
+
+void Profiler::AddSample(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, const char* detail)
+{
+	if (TraceRecorder::IsRecording())
+	{
+		TraceRecorder::AddSpan(name, start, end, detail);
+	}
+
+	const double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+	ProfileFrame& frame = frames[currentFrame.load(std::memory_order_acquire) % PROFILER_HISTORY_FRAMES];
+	const int index = frame.numSamples.fetch_add(1, std::memory_order_relaxed);
+	if (index < PROFILER_MAX_SAMPLES_PER_FRAME)
+	{
+		frame.samples[index] = { name, milliseconds };
+	}
+}
+
+const ProfileFrame& Profiler::GetLastFrame()
+{
+	return frames[(currentFrame + PROFILER_HISTORY_FRAMES - 1) % PROFILER_HISTORY_FRAMES];
+}
+
+std::vector<float> Profiler::GetFrameTimes()
+{
+	const uint64_t numFrames = std::min<uint64_t>(currentFrame, PROFILER_HISTORY_FRAMES - 1);
+	std::vector<float> frameTimes;
+	frameTimes.reserve(numFrames);
+	for (uint64_t frame = currentFrame - numFrames; frame < currentFrame; frame++)
+	{
+		frameTimes.push_back(static_cast<float>(frames[frame % PROFILER_HISTORY_FRAMES].frameMilliseconds));
+	}
+	return frameTimes;
+}
+
+std::vector<ProfileStats> Profiler::GetStats()
+{
+	// The frame being recorded is skipped, its scopes are not all closed yet
+	const uint64_t numFrames = std::min<uint64_t>(currentFrame, PROFILER_HISTORY_FRAMES - 1);
+	const uint64_t firstFrame = currentFrame - numFrames;
+
+	std::vector<ProfileStats> stats;
+	for (uint64_t frame = firstFrame; frame < currentFrame; frame++)
+	{
+		const ProfileFrame& profileFrame = frames[frame % PROFILER_HISTORY_FRAMES];
+		const int numSamples = std::min(profileFrame.numSamples.load(std::memory_order_relaxed), PROFILER_MAX_SAMPLES_PER_FRAME);
+		for (int i = 0; i < numSamples; i++)
+		{
+			const ProfileSample& sample = profileFrame.samples[i];
+			auto scope = std::find_if(stats.begin(), stats.end(), [&sample](const ProfileStats& s) { return s.name == sample.name; });
+			if (scope == stats.end())
+			{
+				ProfileStats newScope;
+				newScope.name = sample.name;
+				newScope.history.assign(numFrames, 0.0f);
+				stats.push_back(newScope);
+				scope = stats.end() - 1;
+			}
+			// A scope can run several times in a frame, one simulation tick each
+			scope->history[frame - firstFrame] += static_cast<float>(sample.milliseconds);
+		}
+	}
+
+	for (auto& scope : stats)
+	{
+		std::vector<float> sorted = scope.history;
+		std::sort(sorted.begin(), sorted.end());
+		double total = 0.0;
+		for (float milliseconds : sorted)
+		{
+			total += milliseconds;
+		}
+		scope.averageMilliseconds = total / sorted.size();
+		scope.p99Milliseconds = sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+		scope.maxMilliseconds = sorted.back();
+	}
+	return stats;
+}
@@ -0,0 +1,94 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Frames kept in the history, and timed scopes kept per frame (the extra ones are dropped)
+const int PROFILER_HISTORY_FRAMES = 256;
+const int PROFILER_MAX_SAMPLES_PER_FRAME = 512;
+
+struct ProfileSample
+{
+	// Must outlive the history, string literals and system names are fine
+	const char* name;
+	double milliseconds;
+};
+
+struct ProfileFrame
+{
+	uint64_t frameNumber = 0;
+	double frameMilliseconds = 0.0;
+	std::atomic<int> numSamples{ 0 };
+	ProfileSample samples[PROFILER_MAX_SAMPLES_PER_FRAME];
+};
+
+// Rolling statistics of one timed scope, summed per frame
+struct ProfileStats
+{
+	std::string name;
+	double averageMilliseconds = 0.0;
+	double p99Milliseconds = 0.0;
+	double maxMilliseconds = 0.0;
+	// Oldest frame first
+	std::vector<float> history;
+};
+
+/////////////////////////
+// PROFILER
+// Timed scopes of the current frame are appended to a ring of frames without locking,
+// each scope reserving its slot with an atomic increment, so systems on worker threads can be timed too
+// While a trace is recorded the scopes are also handed to the TraceRecorder
+// Example: { PROFILE_SCOPE("Registry::Update"); registry->Update(); }
+/////////////////////////
+class Profiler
+{
+private:
+	static ProfileFrame frames[PROFILER_HISTORY_FRAMES];
+	static std::atomic<uint64_t> currentFrame;
+	static std::chrono::steady_clock::time_point frameStart;
+
+public:
+	// Called by the main thread around every frame, no scope may be open in between
+	static void BeginFrame();
+	static void EndFrame();
+
+	// detail only goes to the trace (see TraceRecorder)
+	static void AddSample(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, const char* detail = nullptr);
+
+	// Last finished frame, its samples stay valid until the next EndFrame()
+	static const ProfileFrame& GetLastFrame();
+
+	// Frame time of the finished frames, oldest first
+	static std::vector<float> GetFrameTimes();
+
+	// Statistics of every scope over the finished frames, in the order the scopes were first seen
+	static std::vector<ProfileStats> GetStats();
+};
+
+// Times the enclosing scope
+class ProfileScope
+{
+private:
+	const char* name;
+	const char* detail;
+	std::chrono::steady_clock::time_point start;
+
+public:
+	ProfileScope(const char* name, const char* detail = nullptr) : name(name), detail(detail), start(std::chrono::steady_clock::now()) {}
+
+	~ProfileScope()
+	{
+		Profiler::AddSample(name, start, std::chrono::steady_clock::now(), detail);
+	}
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_SCOPE_DETAIL(name, detail) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name, detail)
+
+#endif
@@ -0,0 +1,97 @@
+#include "ProfilerOverlay.h"
+#include "Profiler.h"
+#include "MemoryStats.h"
+#include "../Game/FramePacer.h"
+#include "../ECS/ECS.h"
+#include <imgui/imgui.h>
+#include <cstdio>
+
+void ProfilerOverlay::Draw(const Registry& registry, const FramePacer& framePacer, const MemoryReport& memoryReport, size_t memoryHighWaterBytes)
+{
+	ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_Once);
+	ImGui::SetNextWindowBgAlpha(0.8f);
+	if (!ImGui::Begin("Profiler", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+	{
+		ImGui::End();
+		return;
+	}
+
+	const std::vector<float> frameTimes = Profiler::GetFrameTimes();
+	if (!frameTimes.empty())
+	{
+		ImGui::Text("Frame: %.2f ms (%.0f FPS)", frameTimes.back(), frameTimes.back() > 0.0f ? 1000.0f / frameTimes.back() : 0.0f);
+		ImGui::PlotLines("##frame", frameTimes.data(), static_cast<int>(frameTimes.size()), 0, "frame time (ms)", 0.0f, 33.3f, ImVec2(360, 60));
+	}
+
+	const FramePacingStats& pacing = framePacer.GetStats();
+	if (framePacer.GetTargetFps() == 0)
+	{
+		ImGui::Text("Pacing: uncapped");
+	}
+	else
+	{
+		ImGui::Text("Pacing: %d FPS, %llu/%llu deadlines missed, jitter avg %.3f ms, max %.3f ms", framePacer.GetTargetFps(),
+			static_cast<unsigned long long>(pacing.numMissedDeadlines), static_cast<unsigned long long>(pacing.numFrames),
+			pacing.averageJitterMilliseconds, pacing.maxJitterMilliseconds);
+		float histogram[PACING_HISTOGRAM_BUCKETS];
+		for (int bucket = 0; bucket < PACING_HISTOGRAM_BUCKETS; bucket++)
+		{
+			histogram[bucket] = static_cast<float>(pacing.jitterHistogram[bucket]);
+		}
+		char label[64];
+		std::snprintf(label, sizeof(label), "jitter, %.2f ms per bar", PACING_BUCKET_MILLISECONDS);
+		ImGui::PlotHistogram("##jitter", histogram, PACING_HISTOGRAM_BUCKETS, 0, label, 0.0f, FLT_MAX, ImVec2(360, 60));
+	}
+
+	ImGui::Separator();
+	ImGui::Columns(4, "scopes");
+	ImGui::Text("scope"); ImGui::NextColumn();
+	ImGui::Text("avg ms"); ImGui::NextColumn();
+	ImGui::Text("p99 ms"); ImGui::NextColumn();
+	ImGui::Text("history"); ImGui::NextColumn();
+	ImGui::Separator();
+	for (const auto& scope : Profiler::GetStats())
+	{
+		ImGui::Text("%s", scope.name.c_str()); ImGui::NextColumn();
+		ImGui::Text("%.3f", scope.averageMilliseconds); ImGui::NextColumn();
+		ImGui::Text("%.3f", scope.p99Milliseconds); ImGui::NextColumn();
+		ImGui::PushID(scope.name.c_str());
+		ImGui::PlotLines("", scope.history.data(), static_cast<int>(scope.history.size()), 0, nullptr, 0.0f, static_cast<float>(scope.maxMilliseconds), ImVec2(120, 20));
+		ImGui::PopID();
+		ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+
+	ImGui::Separator();
+	const char* phaseNames[] = { "pre-update", "simulation", "post-update", "render" };
+	for (int phase = 0; phase < NUM_SYSTEM_PHASES; phase++)
+	{
+		for (const System* system : registry.GetSystemsInPhase(static_cast<SystemPhase>(phase)))
+		{
+			ImGui::Text("[%s] %s: %d entities", phaseNames[phase], system->GetName().c_str(), static_cast<int>(system->GetSystemEntities().size()));
+		}
+	}
+
+	ImGui::Separator();
+	const std::string memoryTitle = "Memory: " + FormatBytes(memoryReport.GetTotalUsedBytes()) + " used, " + FormatBytes(memoryReport.GetTotalCapacityBytes()) +
+		" allocated, peak " + FormatBytes(memoryHighWaterBytes) + "###memory";
+	if (ImGui::CollapsingHeader(memoryTitle.c_str()))
+	{
+		ImGui::Columns(4, "memory");
+		ImGui::Text("owner"); ImGui::NextColumn();
+		ImGui::Text("used"); ImGui::NextColumn();
+		ImGui::Text("allocated"); ImGui::NextColumn();
+		ImGui::Text("peak"); ImGui::NextColumn();
+		ImGui::Separator();
+		for (const auto& entry : memoryReport.GetEntries())
+		{
+			ImGui::Text("%s: %s", entry.category.c_str(), entry.name.c_str()); ImGui::NextColumn();
+			ImGui::Text("%s", FormatBytes(entry.usedBytes).c_str()); ImGui::NextColumn();
+			ImGui::Text("%s", FormatBytes(entry.capacityBytes).c_str()); ImGui::NextColumn();
+			ImGui::Text("%s", FormatBytes(entry.highWaterBytes).c_str()); ImGui::NextColumn();
+		}
+		ImGui::Columns(1);
+	}
+
+	ImGui::End();
+}
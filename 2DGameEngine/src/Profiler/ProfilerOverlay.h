@@ -0,0 +1,18 @@
+#ifndef PROFILEROVERLAY_H
+#define PROFILEROVERLAY_H
+
+#include <cstddef>
+
+class Registry;
+class MemoryReport;
+class FramePacer;
+
+// ImGui window showing the frame time and the cost of every timed scope over the profiler history
+// The ImGui frame must have been started by the caller
+class ProfilerOverlay
+{
+public:
+	void Draw(const Registry& registry, const FramePacer& framePacer, const MemoryReport& memoryReport, size_t memoryHighWaterBytes);
+};
+
+#endif
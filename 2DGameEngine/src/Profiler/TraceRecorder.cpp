@@ -0,0 +1,138 @@
+#include "TraceRecorder.h"
+#include "../Logger/Logger.h"
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+	struct TraceSpan
+	{
+		const char* name;
+		std::chrono::steady_clock::time_point start;
+		std::chrono::steady_clock::time_point end;
+		std::string detail;
+	};
+
+	struct ThreadTrace
+	{
+		int threadId;
+		std::string threadName;
+		std::vector<TraceSpan> spans;
+	};
+
+	// Every thread that recorded something, the buffers live until the program ends
+	std::mutex threadsMutex;
+	std::vector<std::unique_ptr<ThreadTrace>> threads;
+	thread_local ThreadTrace* currentThread = nullptr;
+
+	// Timestamps are written relative to the start of the program
+	const auto traceEpoch = std::chrono::steady_clock::now();
+
+	ThreadTrace& GetCurrentThread()
+	{
+		if (!currentThread)
+		{
+			std::lock_guard<std::mutex> lock(threadsMutex);
+			auto thread = std::make_unique<ThreadTrace>();
+			thread->threadId = static_cast<int>(threads.size()) + 1;
+			thread->threadName = "Thread " + std::to_string(thread->threadId);
+			currentThread = thread.get();
+			threads.push_back(std::move(thread));
+		}
+		return *currentThread;
+	}
+
+	double ToMicroseconds(std::chrono::steady_clock::time_point time)
+	{
+		return std::chrono::duration<double, std::micro>(time - traceEpoch).count();
+	}
+
+	std::string EscapeJson(const std::string& text)
+	{
+		std::string escaped;
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\')
+			{
+				escaped += '\\';
+			}
+			escaped += c;
+		}
+		return escaped;
+	}
+}
+
+std::atomic<bool> TraceRecorder::isRecording{ false };
+
+void TraceRecorder::Start()
+{
+	{
+		std::lock_guard<std::mutex> lock(threadsMutex);
+		for (auto& thread : threads)
+		{
+			thread->spans.clear();
+		}
+	}
+	isRecording = true;
+	Logger::Log("Trace recording started");
+}
+
+void TraceRecorder::Stop()
+{
+	isRecording = false;
+	Logger::Log("Trace recording stopped");
+}
+
+void TraceRecorder::AddSpan(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, const char* detail)
+{
+	GetCurrentThread().spans.push_back({ name, start, end, detail ? detail : "" });
+}
+
+void TraceRecorder::SetThreadName(const std::string& name)
+{
+	ThreadTrace& thread = GetCurrentThread();
+	std::lock_guard<std::mutex> lock(threadsMutex);
+	thread.threadName = name;
+}
+
+// Must be called once recording stopped and no thread is still running a profiled scope
+bool TraceRecorder::Write(const std::string& path)
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		Logger::Err("Cannot write trace to " + path);
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(threadsMutex);
+	size_t numSpans = 0;
+	bool isFirstEvent = true;
+	file << std::fixed << std::setprecision(3);
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	for (const auto& thread : threads)
+	{
+		file << (isFirstEvent ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->threadId
+			<< ",\"args\":{\"name\":\"" << EscapeJson(thread->threadName) << "\"}}";
+		isFirstEvent = false;
+
+		for (const auto& span : thread->spans)
+		{
+			file << ",\n{\"name\":\"" << EscapeJson(span.name) << "\",\"cat\":\"engine\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->threadId
+				<< ",\"ts\":" << ToMicroseconds(span.start) << ",\"dur\":" << ToMicroseconds(span.end) - ToMicroseconds(span.start);
+			if (!span.detail.empty())
+			{
+				file << ",\"args\":{\"detail\":\"" << EscapeJson(span.detail) << "\"}";
+			}
+			file << "}";
+		}
+		numSpans += thread->spans.size();
+	}
+	file << "\n]}\n";
+
+	Logger::Log("Trace with " + std::to_string(numSpans) + " spans written to " + path);
+	return true;
+}
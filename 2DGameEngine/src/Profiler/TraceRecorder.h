@@ -0,0 +1,35 @@
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+/////////////////////////
+// TRACE RECORDER
+// While recording, every profiled scope is also kept as a span of the thread that ran it,
+// and the spans are written as Chrome trace events that chrome://tracing and Perfetto can open
+// Each thread appends to its own buffer, so recording takes no lock once a thread has its buffer
+/////////////////////////
+class TraceRecorder
+{
+private:
+	static std::atomic<bool> isRecording;
+
+public:
+	static bool IsRecording() { return isRecording.load(std::memory_order_relaxed); }
+
+	// Drops the spans of a previous recording
+	static void Start();
+	static void Stop();
+
+	// detail is optional, shown as the span argument (an asset path for example)
+	static void AddSpan(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, const char* detail);
+
+	// Names the calling thread in the trace, threads are numbered otherwise
+	static void SetThreadName(const std::string& name);
+
+	static bool Write(const std::string& path);
+};
+
+#endif
@@ -4,7 +4,7 @@
 #include "../ECS/ECS.h"
 #include "../Components/AnimationComponent.h"
 #include "../Components/SpriteComponent.h"
-#include <SDL.h>
+#include "../Game/FrameContext.h"
 
 class AnimationSystem: public System
 {
@@ -13,17 +13,27 @@ public:
 	{
 		RequireComponent<SpriteComponent>();
 		RequireComponent<AnimationComponent>();
+		SetPhase(SystemPhase::Simulation);
 	}
-	void Update()
+
+	void Run(FrameContext& context) override
 	{
-		for (auto entity : GetSystemEntities())
-		{
-			auto& animation = entity.GetComponent<AnimationComponent>();
-			auto& sprite = entity.GetComponent<SpriteComponent>();
+		Update(static_cast<int>(context.simulationTime * 1000.0));
+	}
 
-			animation.currentFrame = ((SDL_GetTicks() - animation.startTime) * animation.frameSpeedRate / 1000) % animation.numFrames;
+	// Animations follow the simulation clock, so they keep in step with the movement when the game runs faster than real time
+	void Update(int simulationMilliseconds)
+	{
+		const auto ticks = simulationMilliseconds;
+		registry->View<SpriteComponent, AnimationComponent>().ParallelEach([ticks](Entity, SpriteComponent& sprite, AnimationComponent& animation)
+		{
+			if (animation.startTime < 0)
+			{
+				animation.startTime = ticks;
+			}
+			animation.currentFrame = ((ticks - animation.startTime) * animation.frameSpeedRate / 1000) % animation.numFrames;
 			sprite.srcRect.x = animation.currentFrame * sprite.width;
-		}
+		});
 	}
 };
 
@@ -4,70 +4,304 @@
 #include "../ECS/ECS.h"
 #include "../Components/BoxColliderComponent.h"
 #include "../Components/TransformComponent.h"
+#include "../Components/RigidBodyComponent.h"
 #include "../Logger/Logger.h"
+#include "../Game/FrameContext.h"
+#include "../Physics/Broadphase.h"
+#include "../Physics/SpatialHash.h"
+#include "../Physics/AABBTree.h"
+#include "../Physics/StaticAABBTree.h"
+#include "../Physics/OverlapKernel.h"
+#include <glm/glm.hpp>
+#include <memory>
+#include <utility>
+#include <vector>
 
+// Collider hit by CollisionSystem::Raycast()
+struct ColliderHit
+{
+	bool hasHit = false;
+	Entity entity = Entity(-1);
+	float distance = 0.0f;
+	glm::vec2 point = glm::vec2(0.0f);
+};
+
+// Below this many dynamic colliders the candidate pairs are tested straight on their boxes: gathering the boxes
+// into arrays for the overlap kernel costs more than it saves while they all fit in the cache
+// (narrowphase benchmark, -O2: about 2.5 ns per pair tested directly against 4 ns with SSE2 at 1k-5k colliders,
+// the kernel ahead from 8k, 5.5 against 12 ns at 30k)
+const int MIN_COLLIDERS_FOR_OVERLAP_KERNEL = 8000;
+
+/////////////////////////
+// COLLISION SYSTEM
+// Colliders without a rigid body, or flagged static, never move: they are baked once into a static tree and only
+// baked again when the members of the system change or InvalidateStaticColliders() is called
+// Every tick the dynamic colliders go through the broadphase, then each one is checked against the static tree,
+// two static colliders are never tested against each other
+/////////////////////////
 class CollisionSystem : public System
 {
+private:
+	std::unique_ptr<IBroadphase> broadphase;
+
+	// [index = dynamic collider] kept until the members change, the boxes are read again every tick
+	std::vector<Entity> colliders;
+	std::vector<AABB> bounds;
+	std::vector<std::pair<int, int>> candidatePairs;
+	// The same boxes as one array per side, for the narrowphase kernel of the large scenes
+	AABBArrays colliderArrays;
+
+	// [index = static collider] the entities and boxes baked into staticTree
+	std::vector<Entity> staticColliders;
+	std::vector<AABB> staticBounds;
+	StaticAABBTree staticTree;
+	bool isStaticTreeOutdated = true;
+	int numStaticBakes = 0;
+	// Static colliders found by the last classification, compared with the baked ones
+	std::vector<Entity> currentStaticColliders;
+	// Membership version of the system when colliders was classified
+	int classifiedMembershipVersion = -1;
+	// Reused every tick, the (dynamic, static) candidate pairs
+	std::vector<std::pair<int, int>> staticCandidatePairs;
+
+	// Scene queries run on an AABB tree: the broadphase itself when it is one, otherwise queryTree,
+	// brought up to date by the first query after a tick so the scenes that never query do not pay for it
+	const AABBTreeBroadphase* treeBroadphase = nullptr;
+	AABBTreeBroadphase queryTree;
+	bool isQueryTreeOutdated = true;
+
+	const DynamicAABBTree& GetQueryTree()
+	{
+		if (treeBroadphase)
+		{
+			return treeBroadphase->GetTree();
+		}
+		if (isQueryTreeOutdated)
+		{
+			queryTree.Update(bounds);
+			isQueryTreeOutdated = false;
+		}
+		return queryTree.GetTree();
+	}
+
+	// Splits the members into dynamic and static colliders, the static tree is outdated if the static ones changed
+	void ClassifyColliders()
+	{
+		colliders.clear();
+		currentStaticColliders.clear();
+		for (auto entity : GetSystemEntities())
+		{
+			if (IsStaticCollider(entity))
+			{
+				currentStaticColliders.push_back(entity);
+			}
+			else
+			{
+				colliders.push_back(entity);
+			}
+		}
+		if (currentStaticColliders != staticColliders)
+		{
+			staticColliders.swap(currentStaticColliders);
+			isStaticTreeOutdated = true;
+		}
+		classifiedMembershipVersion = GetMembershipVersion();
+	}
+
+	void BakeStaticColliders()
+	{
+		staticBounds.clear();
+		for (auto entity : staticColliders)
+		{
+			staticBounds.push_back(GetColliderBounds(entity));
+		}
+		staticTree.Build(staticBounds);
+		isStaticTreeOutdated = false;
+		numStaticBakes++;
+		Logger::Log("Baked " + std::to_string(staticColliders.size()) + " static colliders");
+	}
+
+	void OnCollision(Entity a, Entity b)
+	{
+		Logger::Log("Entity " + std::to_string(a.GetId()) + " is colliding with entity " + std::to_string(b.GetId()));
+
+		// TODO: emit an event
+	}
+
 public:
-	CollisionSystem()
+	// cellSize is the grid cell of the spatial hash in pixels, best around twice the size of the usual collider
+	CollisionSystem(BroadphaseType broadphaseType = BroadphaseType::SpatialHash, float cellSize = DEFAULT_COLLISION_CELL_SIZE)
+	{
+		SetBroadphase(CreateBroadphase(broadphaseType, cellSize));
+		RequireComponent<BoxColliderComponent>(ComponentAccess::Read);
+		RequireComponent<TransformComponent>(ComponentAccess::Read);
+		// Tells the dynamic colliders apart
+		UseComponent<RigidBodyComponent>(ComponentAccess::Read);
+		// Collisions are checked once everything has moved
+		SetPhase(SystemPhase::PostUpdate);
+	}
+
+	void Run(FrameContext&) override
+	{
+		Update();
+	}
+
+	void SetBroadphase(std::unique_ptr<IBroadphase> broadphase)
+	{
+		this->broadphase = std::move(broadphase);
+		treeBroadphase = dynamic_cast<const AABBTreeBroadphase*>(this->broadphase.get());
+		isQueryTreeOutdated = true;
+	}
+	const IBroadphase& GetBroadphase() const { return *broadphase; }
+
+	// Static colliders are not expected to move, call this after moving one or changing an isStatic flag
+	// so the next tick classifies and bakes them again
+	void InvalidateStaticColliders()
+	{
+		isStaticTreeOutdated = true;
+		classifiedMembershipVersion = -1;
+	}
+
+	int GetNumDynamicColliders() const { return static_cast<int>(colliders.size()); }
+	int GetNumStaticColliders() const { return static_cast<int>(staticColliders.size()); }
+	int GetNumStaticBakes() const { return numStaticBakes; }
+
+	// Colliders without a rigid body, or flagged static: a flagged collider is baked even if its rigid body moves it,
+	// call InvalidateStaticColliders() after such a move
+	static bool IsStaticCollider(Entity entity)
 	{
-		RequireComponent<BoxColliderComponent>();
-		RequireComponent<TransformComponent>();
+		return !entity.HasComponent<RigidBodyComponent>() || entity.GetComponent<BoxColliderComponent>().isStatic;
+	}
+
+	static AABB GetColliderBounds(Entity entity)
+	{
+		const auto& transform = entity.GetComponent<TransformComponent>();
+		const auto& collider = entity.GetComponent<BoxColliderComponent>();
+		const float x = transform.position.x + collider.offset.x;
+		const float y = transform.position.y + collider.offset.y;
+		return AABB(x, y, x + collider.width, y + collider.height);
 	}
 
 	void Update()
 	{
-		auto entities = GetSystemEntities();
+		// Colliders are only classified again when an entity joins or leaves, or gains or loses its rigid body
+		if (classifiedMembershipVersion != GetMembershipVersion())
+		{
+			ClassifyColliders();
+		}
+		if (isStaticTreeOutdated)
+		{
+			BakeStaticColliders();
+		}
+
+		// Only the boxes of the dynamic colliders are read every tick
+		bounds.clear();
+		isQueryTreeOutdated = true;
+		for (auto entity : colliders)
+		{
+			bounds.push_back(GetColliderBounds(entity));
+		}
+
+		// Broadphase: only the colliders whose boxes may overlap are tested against each other
+		broadphase->Update(bounds);
+		candidatePairs.clear();
+		broadphase->FindPairs(candidatePairs);
 
-		// Loop all the entities that the system is interested in
-		for (auto i = entities.begin(); i != entities.end(); i++)
+		staticCandidatePairs.clear();
+		for (int i = 0; i < static_cast<int>(bounds.size()); i++)
 		{
-			Entity a = *i;
-			auto aTransform = a.GetComponent<TransformComponent>();
-			auto aCollider = a.GetComponent<BoxColliderComponent>();
-			// Loop all the entities that still need to be checked (to the right of i)
-			for (auto j = i; j != entities.end(); j++)
+			staticTree.QueryAABB(bounds[i], [this, i](int staticIndex)
 			{
-				Entity b = *j;
-
-				// Bypass if we are trying to test the same entity
-				if (a == b)
-				{
-					continue;
-				}
-
-				auto bTransform = b.GetComponent<TransformComponent>();
-				auto bCollider = b.GetComponent<BoxColliderComponent>();
-
-				// Perform the AABB collision check between entities a and b
-				bool collisionHappened = CheckAABBCollision(
-					aTransform.position.x + aCollider.offset.x,
-					aTransform.position.y + aCollider.offset.y,
-					aCollider.width,
-					aCollider.height,
-					bTransform.position.x + bCollider.offset.x,
-					bTransform.position.y + bCollider.offset.y,
-					bCollider.width,
-					bCollider.height
-				);
-				if (collisionHappened)
-				{
-					Logger::Log("Entity " + std::to_string(a.GetId()) + " is colliding with entity " + std::to_string(b.GetId()));
-
-					// TODO: emit an event
-				}
+				staticCandidatePairs.emplace_back(i, staticIndex);
+				return true;
+			});
+		}
+
+		// Narrowphase: the colliding candidate pairs are kept in place, tested one by one in the small scenes
+		// and several at once by the kernel in the large ones
+		// The static tree already tested its boxes exactly, its pairs are all colliding
+		int numCollidingPairs = 0;
+		if (static_cast<int>(bounds.size()) < MIN_COLLIDERS_FOR_OVERLAP_KERNEL)
+		{
+			for (const auto& pair : candidatePairs)
+			{
+				candidatePairs[numCollidingPairs] = pair;
+				numCollidingPairs += bounds[pair.first].Overlaps(bounds[pair.second]);
 			}
 		}
+		else
+		{
+			colliderArrays.Assign(bounds);
+			numCollidingPairs = GetOverlapKernel().filterPairs(colliderArrays, colliderArrays, candidatePairs.data(), static_cast<int>(candidatePairs.size()), candidatePairs.data());
+		}
+		candidatePairs.resize(numCollidingPairs);
+
+		for (const auto& pair : candidatePairs)
+		{
+			OnCollision(colliders[pair.first], colliders[pair.second]);
+		}
+		for (const auto& pair : staticCandidatePairs)
+		{
+			OnCollision(colliders[pair.first], staticColliders[pair.second]);
+		}
+	}
+
+	////////////////////////////////////////////////
+	// Scene queries, over the colliders where the last collision tick saw them
+	// Call them from the main thread or from systems that run after the collision phase,
+	// the first query after a tick may update the query tree
+	////////////////////////////////////////////////
+
+	// Calls callback(Entity) for every collider overlapping area, until the callback returns false
+	// Example: collisionSystem.QueryAABB(AABB(0, 0, 64, 64), [](Entity entity) { ...; return true; });
+	template <typename TCallback>
+	void QueryAABB(const AABB& area, TCallback callback)
+	{
+		bool isDone = false;
+		GetQueryTree().QueryAABB(area, [this, &callback, &isDone](int index) { isDone = !callback(colliders[index]); return !isDone; });
+		if (!isDone)
+		{
+			staticTree.QueryAABB(area, [this, &callback](int index) { return callback(staticColliders[index]); });
+		}
 	}
 
-	bool CheckAABBCollision(double aX, double aY, double aW, double aH, double bX, double bY, double bW, double bH)
+	// Calls callback(Entity) for every collider holding the point, until the callback returns false
+	template <typename TCallback>
+	void QueryPoint(glm::vec2 point, TCallback callback)
 	{
-		return (
-			aX < bX + bW &&
-			aX + aW > bX &&
-			aY < bY + bH &&
-			aY + aH > bY
-			);
+		bool isDone = false;
+		GetQueryTree().QueryPoint(point, [this, &callback, &isDone](int index) { isDone = !callback(colliders[index]); return !isDone; });
+		if (!isDone)
+		{
+			staticTree.QueryPoint(point, [this, &callback](int index) { return callback(staticColliders[index]); });
+		}
+	}
+
+	// First collider along the ray within maxDistance pixels, ignoring the collider of ignoredEntity (the shooter)
+	// A line of sight is clear when nothing is hit before the target
+	ColliderHit Raycast(glm::vec2 origin, glm::vec2 direction, float maxDistance, Entity ignoredEntity = Entity(-1))
+	{
+		ColliderHit hit;
+		const RaycastHit dynamicHit = GetQueryTree().Raycast(origin, direction, maxDistance, [this, ignoredEntity](int index) { return colliders[index] != ignoredEntity; });
+		if (dynamicHit.HasHit())
+		{
+			hit.hasHit = true;
+			hit.entity = colliders[dynamicHit.userData];
+			hit.distance = dynamicHit.distance;
+			hit.point = dynamicHit.point;
+			// A static collider only matters in front of it
+			maxDistance = dynamicHit.distance;
+		}
+
+		const RaycastHit staticHit = staticTree.Raycast(origin, direction, maxDistance, [this, ignoredEntity](int index) { return staticColliders[index] != ignoredEntity; });
+		if (staticHit.HasHit() && (!hit.hasHit || staticHit.distance < hit.distance))
+		{
+			hit.hasHit = true;
+			hit.entity = staticColliders[staticHit.userData];
+			hit.distance = staticHit.distance;
+			hit.point = staticHit.point;
+		}
+		return hit;
 	}
 };
 
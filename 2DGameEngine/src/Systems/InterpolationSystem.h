@@ -0,0 +1,34 @@
+#ifndef INTERPOLATIONSYSTEM_H
+#define INTERPOLATIONSYSTEM_H
+
+#include "../ECS/ECS.h"
+#include "../Components/TransformComponent.h"
+#include "../Game/FrameContext.h"
+
+// Remembers where every entity was before the simulation tick moves it,
+// so rendering can blend between the last two ticks
+class InterpolationSystem : public System
+{
+public:
+	InterpolationSystem()
+	{
+		RequireComponent<TransformComponent>();
+		SetPhase(SystemPhase::PreUpdate);
+	}
+
+	void Run(FrameContext&) override
+	{
+		Update();
+	}
+
+	void Update()
+	{
+		registry->View<TransformComponent>().ParallelEach([](Entity, TransformComponent& transform)
+		{
+			transform.previousPosition = transform.position;
+			transform.previousRotation = transform.rotation;
+		});
+	}
+};
+
+#endif
@@ -5,6 +5,7 @@
 #include "../Components/TransformComponent.h"
 #include "../Components/RigidBodyComponent.h"
 #include "../Logger/Logger.h"
+#include "../Game/FrameContext.h"
 
 class MovementSystem : public System
 {
@@ -12,24 +13,26 @@ public:
 	MovementSystem()
 	{
 		RequireComponent<TransformComponent>();
-		RequireComponent<RigidBodyComponent>();
+		RequireComponent<RigidBodyComponent>(ComponentAccess::Read);
+		SetPhase(SystemPhase::Simulation);
+	}
 
+	void Run(FrameContext& context) override
+	{
+		Update(context.deltaTime);
 	}
 
 	void Update(double deltaTime)
 	{
 		//Loop all entities that the system is interested in
-		for (auto entity : GetSystemEntities())
+		registry->View<TransformComponent, RigidBodyComponent>().ParallelEach([deltaTime](Entity, TransformComponent& transform, const RigidBodyComponent& rigidBody)
 		{
-			auto& transform = entity.GetComponent<TransformComponent>();
-			const auto rigidBody = entity.GetComponent<RigidBodyComponent>();
-
 			transform.position.x += rigidBody.velocity.x * deltaTime;
 			transform.position.y += rigidBody.velocity.y * deltaTime;
 
 			/*Logger::Log("Entity id = " + std::to_string(entity.GetId()) +
 				" position is now (" + std::to_string(transform.position.x) + "," + std::to_string(transform.position.y) + ")");*/
-		}
+		});
 
 	}
 };
@@ -4,6 +4,7 @@
 #include "../ECS/ECS.h"
 #include "../Components/TransformComponent.h"
 #include "../Components/BoxColliderComponent.h"
+#include "../Game/FrameContext.h"
 #include <SDL.h>
 
 class RenderColliderSystem : public System
@@ -11,20 +12,29 @@ class RenderColliderSystem : public System
 public:
 	RenderColliderSystem()
 	{
-		RequireComponent<TransformComponent>();
-		RequireComponent<BoxColliderComponent>();
+		RequireComponent<TransformComponent>(ComponentAccess::Read);
+		RequireComponent<BoxColliderComponent>(ComponentAccess::Read);
+		SetPhase(SystemPhase::Render);
 	}
 
-	void Update(SDL_Renderer* renderer)
+	void Run(FrameContext& context) override
 	{
-		for (auto entity : GetSystemEntities())
+		// Colliders are only drawn in debug mode
+		if (context.isDebug)
 		{
-			const auto transform = entity.GetComponent<TransformComponent>();
-			const auto collider = entity.GetComponent<BoxColliderComponent>();
+			Update(context.renderer, context.interpolationAlpha);
+		}
+	}
 
+	void Update(SDL_Renderer* renderer, double interpolationAlpha = 1.0)
+	{
+		for (auto [entity, transform, collider] : registry->View<TransformComponent, BoxColliderComponent>())
+		{
+			// Draw the collider where the sprite is drawn
+			const glm::vec2 position = glm::mix(transform.previousPosition, transform.position, static_cast<float>(interpolationAlpha));
 			SDL_Rect colliderRect = {
-				static_cast<int>(transform.position.x + collider.offset.x),
-				static_cast<int>(transform.position.y + collider.offset.y),
+				static_cast<int>(position.x + collider.offset.x),
+				static_cast<int>(position.y + collider.offset.y),
 				static_cast<int>(collider.width),
 				static_cast<int>(collider.height)
 			};
@@ -6,6 +6,7 @@
 #include "../Components/SpriteComponent.h"
 #include "../Logger/Logger.h"
 #include "../AssetStore/AssetStore.h"
+#include "../Game/FrameContext.h"
 #include <SDL.h>
 #include <algorithm>
 
@@ -14,45 +15,53 @@ class RenderSystem : public System
 public:
 	RenderSystem()
 	{
-		RequireComponent<TransformComponent>();
-		RequireComponent<SpriteComponent>();
+		RequireComponent<TransformComponent>(ComponentAccess::Read);
+		RequireComponent<SpriteComponent>(ComponentAccess::Read);
+		SetPhase(SystemPhase::Render);
 	}
 
-	void Update(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& assetStore)
+	void Run(FrameContext& context) override
+	{
+		Update(context.renderer, context.assetStore, context.interpolationAlpha);
+	}
+
+	void Update(SDL_Renderer* renderer, AssetStore* assetStore, double interpolationAlpha = 1.0)
 	{
 		// Create a vector with both Sprite and Transform component of all entities
+		// The components are not copied, nothing is added or removed from the pools while rendering
 		struct RenderableEntity
 		{
-			TransformComponent transformComponent;
-			SpriteComponent spriteComponent;
+			const TransformComponent* transformComponent;
+			const SpriteComponent* spriteComponent;
 		};
 		std::vector<RenderableEntity> renderableEntities;
-		for (auto entity : GetSystemEntities())
+		for (auto [entity, transform, sprite] : registry->View<TransformComponent, SpriteComponent>())
 		{
-			RenderableEntity renderableEntity;
-			renderableEntity.spriteComponent = entity.GetComponent<SpriteComponent>();
-			renderableEntity.transformComponent = entity.GetComponent<TransformComponent>();
-			renderableEntities.emplace_back(renderableEntity);
+			renderableEntities.push_back({ &transform, &sprite });
 		}
 		// Sort the vector
 		std::sort(renderableEntities.begin(), renderableEntities.end(), [](const RenderableEntity& a, const RenderableEntity& b)
 			{
-				return a.spriteComponent.zIndex < b.spriteComponent.zIndex;
+				return a.spriteComponent->zIndex < b.spriteComponent->zIndex;
 			});
 
 		//Loop all entities that the system is interested in
-		for (auto entity : renderableEntities)
+		for (const auto& entity : renderableEntities)
 		{
-			const auto transform = entity.transformComponent;
-			const auto sprite = entity.spriteComponent;
+			const auto& transform = *entity.transformComponent;
+			const auto& sprite = *entity.spriteComponent;
 			
 			// set the source rectangle of our original sprite texture
 			SDL_Rect srcRect = sprite.srcRect;
 
+			// blend between the last two simulation ticks
+			const glm::vec2 position = glm::mix(transform.previousPosition, transform.position, static_cast<float>(interpolationAlpha));
+			const double rotation = transform.previousRotation + (transform.rotation - transform.previousRotation) * interpolationAlpha;
+
 			// set the destination rectangle with the x,y position to be rendered
 			SDL_Rect dstRect = {
-				static_cast<int>(transform.position.x),
-				static_cast<int>(transform.position.y),
+				static_cast<int>(position.x),
+				static_cast<int>(position.y),
 				static_cast<int>(sprite.width * transform.scale.x),
 				static_cast<int>(sprite.height * transform.scale.y)
 			};
@@ -62,7 +71,7 @@ public:
 				assetStore->GetTexture(sprite.assetId),
 				&srcRect,
 				&dstRect,
-				transform.rotation,
+				rotation,
 				NULL,
 				SDL_FLIP_NONE);
 